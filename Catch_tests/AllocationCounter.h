@@ -0,0 +1,28 @@
+#ifndef NEWICK_ALLOCATIONCOUNTER_H
+#define NEWICK_ALLOCATIONCOUNTER_H
+#include "profile.h"
+
+/*
+ * Counts allocations since construction. This only works in test binaries linking the
+ * counting `operator new` from the newick_alloc_hooks target.
+ *
+ * Catch2 assertions allocate, too. So read the counter into a variable before checking it.
+ */
+class AllocationCounter {
+    unsigned long count_start;
+    unsigned long bytes_start;
+
+public:
+    AllocationCounter() : count_start {allocation_count()}, bytes_start {allocation_bytes()} {
+    }
+
+    [[nodiscard]] unsigned long allocations() const {
+        return allocation_count() - count_start;
+    }
+
+    [[nodiscard]] unsigned long bytes() const {
+        return allocation_bytes() - bytes_start;
+    }
+};
+
+#endif //NEWICK_ALLOCATIONCOUNTER_H
@@ -0,0 +1,145 @@
+/*
+ * Allocation budgets for the hot paths.
+ */
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "AllocationCounter.h"
+#include "events.h"
+#include "generate.h"
+#include "node.h"
+#include "parser.h"
+
+static constexpr unsigned long TIPS { 10000 };
+static constexpr unsigned long NODES { 2 * TIPS - 1 };
+
+static std::string newick(const TreeModel model) {
+    std::ostringstream out;
+    TreeGenerator(GeneratorOptions {model, TIPS, 1, exponential_lengths}).generate().write_newick(out);
+    return out.str();
+}
+
+/*
+ * Allocations caused by amortised growth of `n` vectors (or strings) to size `size`.
+ */
+static unsigned long growth(const unsigned long n, const unsigned long size) {
+    return n * (std::bit_width(size) + 1);
+}
+
+
+TEST_CASE("alloc_counter", "[alloc]") {
+    const AllocationCounter counter;
+    const auto p { std::make_unique<long>(1) };
+    const unsigned long allocations { counter.allocations() };
+    const unsigned long bytes { counter.bytes() };
+    CHECK(allocations == 1);
+    CHECK(bytes == sizeof(long));
+}
+
+TEST_CASE("alloc_counter_aligned", "[alloc]") {
+    struct alignas(64) Line {
+        char bytes[64];
+    };
+    const AllocationCounter counter;
+    const auto p { std::make_unique<Line>() };
+    const auto array { std::make_unique<Line[]>(3) };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(allocations == 2);
+    CHECK(reinterpret_cast<std::uintptr_t>(p.get()) % 64 == 0);
+    CHECK(reinterpret_cast<std::uintptr_t>(array.get()) % 64 == 0);
+}
+
+TEST_CASE("parse_alloc", "[alloc]") {
+    for (const auto model : {balanced, caterpillar, yule}) {
+        const std::string input { newick(model) };
+        const AllocationCounter counter;
+        const auto tree { parse(input) };
+        const unsigned long allocations { counter.allocations() };
+        // One allocation for each node, and one for the children of each internal node.
+        CHECK(allocations <= 2 * NODES);
+    }
+}
+
+TEST_CASE("newick_string_alloc", "[alloc]") {
+    const std::string input { newick(balanced) };
+    const AllocationCounter counter;
+    const NewickString newick_string { input };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(allocations == 1);
+}
+
+TEST_CASE("postorder_alloc", "[alloc]") {
+    for (const auto model : {balanced, caterpillar, yule}) {
+        const auto tree { parse(newick(model)) };
+        const AllocationCounter counter;
+        const auto nodes { tree->postorder_traversal() };
+        const unsigned long allocations { counter.allocations() };
+        CHECK(nodes.size() == NODES);
+        // Only the result and the stack grow, no allocations per node.
+        CHECK(allocations <= growth(2, NODES));
+    }
+}
+
+TEST_CASE("traverse_alloc", "[alloc]") {
+    for (const auto model : {balanced, caterpillar, yule}) {
+        const auto tree { parse(newick(model)) };
+        const AllocationCounter counter;
+        const auto nodes { tree->traverse() };
+        const unsigned long allocations { counter.allocations() };
+        CHECK(nodes.size() == NODES);
+        CHECK(allocations <= growth(2, NODES));
+    }
+}
+
+TEST_CASE("to_newick_alloc", "[alloc]") {
+    const std::string input { newick(yule) };
+    const auto tree { parse(input) };
+    const AllocationCounter counter;
+    const std::string output { tree->to_newick() };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(output == input);
+    CHECK(allocations <= growth(2, input.size()));
+}
+
+TEST_CASE("resolve_polytomies_alloc", "[alloc]") {
+    const auto tree { parse(newick(star)) };
+    const AllocationCounter counter;
+    tree->resolve_polytomies();
+    const unsigned long allocations { counter.allocations() };
+    // One new node and its children for each resolved polytomy, plus the stack.
+    CHECK(allocations <= 2 * TIPS + growth(1, TIPS));
+}
+
+TEST_CASE("validate_alloc", "[alloc]") {
+    const std::string input { newick(yule) + "\n" + newick(star) };
+    const AllocationCounter counter;
+    const bool valid { !validate(input) };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(valid);
+    CHECK(allocations == 0);
+}
+
+TEST_CASE("parse_events_alloc", "[alloc]") {
+    const std::string input { newick(yule) };
+    TreeHandler handler;
+    const AllocationCounter counter;
+    const bool valid { !parse_events(input, handler) };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(valid);
+    CHECK(allocations == 0);
+}
+
+TEST_CASE("leaf_labels_alloc", "[alloc]") {
+    const std::string input { newick(yule) };
+    const AllocationCounter counter;
+    const auto labels { leaf_labels(input) };
+    const unsigned long allocations { counter.allocations() };
+    CHECK(labels.size() == TIPS);
+    // Only the growth of the result.
+    CHECK(allocations <= growth(1, TIPS));
+}
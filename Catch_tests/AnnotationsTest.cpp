@@ -0,0 +1,42 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "annotations.h"
+#include "parser.h"
+
+
+TEST_CASE("beast_annotations", "[regular]") {
+    const std::string newick {
+        "(a[&rate=0.5,height_95%_HPD={1.5,2.5},name=\"x,y\"]:1,b[&rate=abc]:2)[&rate=1,n=3];" };
+    std::vector<Comment> comments;
+    const auto tree { parse(newick, comments) };
+    Annotations annotations { *tree, comments };
+    REQUIRE(annotations.get_nodes().size() == 3);
+    CHECK(annotations.get_nodes()[1]->name == "a");
+
+    const auto& rate { annotations.doubles("rate") };
+    CHECK(rate[0] == 1.0);
+    CHECK(rate[1] == 0.5);
+    CHECK(!rate[2]);  // Not a number.
+    CHECK(&annotations.doubles("rate") == &rate);  // Decoded once.
+
+    CHECK(annotations.ints("n")[0] == 3);
+    CHECK(!annotations.ints("n")[1]);
+    CHECK(annotations.strings("name")[1] == "x,y");
+    CHECK(annotations.arrays("height_95%_HPD")[1] == std::vector<double> {1.5, 2.5});
+    CHECK(!annotations.arrays("height_95%_HPD")[0]);
+    CHECK(!annotations.doubles("missing")[1]);
+}
+
+TEST_CASE("nhx_annotations", "[regular]") {
+    const std::string newick { "(a:1[&&NHX:S=human:B=100],b:2[&&NHX:S=chimp])c;" };
+    std::vector<Comment> comments;
+    const auto tree { parse(newick, comments) };
+    Annotations annotations { *tree, comments };
+    CHECK(annotations.strings("S")[1] == "human");
+    CHECK(annotations.strings("S")[2] == "chimp");
+    CHECK(annotations.ints("B")[1] == 100);
+    CHECK(!annotations.ints("B")[2]);
+}
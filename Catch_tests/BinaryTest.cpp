@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "binary.h"
+#include "parser.h"
+
+
+static std::string write_temporary(const std::string& newick) {
+    const auto path { (std::filesystem::temp_directory_path() / "newick_binary_test.nwkb").string() };
+    const auto tree { parse(newick) };
+    std::ofstream out(path, std::ios::binary);
+    to_binary(*tree, out);
+    return path;
+}
+
+TEST_CASE("binary_roundtrip", "[regular]") {
+    const std::string path { write_temporary("((a:1.5,b)c:2,d:0.25)e;") };
+    const BinaryTree binary { path };
+    REQUIRE(binary.size() == 5);
+    CHECK(binary.subtree_size(0) == 5);
+    CHECK(binary.subtree_size(1) == 3);
+    CHECK(binary.label(1) == "c");
+    CHECK(binary.label(4) == "d");
+    CHECK(binary.branch_length(2) == 1.5);
+    CHECK(std::isnan(binary.branch_length(3)));
+    CHECK(!binary.has_attributes());
+    CHECK(binary.to_node()->to_newick() == "((a:1.5,b)c:2,d:0.25)e;");
+    std::filesystem::remove(path);
+}
+
+/*
+ * Write the binary form of a small tree, with the 64-bit word at byte `offset` replaced by
+ * `value`, and cut to `size` bytes.
+ */
+static std::string write_corrupt(const std::size_t offset, const std::uint64_t value, const std::size_t size = 1000) {
+    std::ostringstream out;
+    to_binary(*parse("((a:1.5,b)c:2,d:0.25)e;"), out);
+    std::string data { out.str() };
+    std::memcpy(data.data() + offset, &value, sizeof value);
+    data.resize(std::min(size, data.size()));
+    const auto path { (std::filesystem::temp_directory_path() / "newick_binary_corrupt.nwkb").string() };
+    std::ofstream(path, std::ios::binary) << data;
+    return path;
+}
+
+TEST_CASE("binary_invalid", "[regular]") {
+    const auto path { (std::filesystem::temp_directory_path() / "newick_binary_test.nwk").string() };
+    std::ofstream(path) << "(a,b)c;";
+    CHECK_THROWS_AS(BinaryTree(path), std::runtime_error);
+    CHECK(!is_binary("(a,b)c;"));
+    std::filesystem::remove(path);
+
+    // The layout: a 40 byte header (nodes at 8, label_bytes at 16), then 5 subtree sizes,
+    // 5 branch lengths, 6 label offsets and 8 bytes of labels.
+    CHECK_NOTHROW(BinaryTree(write_corrupt(40, 5)));
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(40, 5, 100)), std::runtime_error);  // Truncated.
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(8, 0)), std::runtime_error);
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(8, std::uint64_t {1} << 61)), std::runtime_error);  // Overflow.
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(16, ~std::uint64_t {0})), std::runtime_error);
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(40 + 3 * 8, 9)), std::runtime_error);  // Subtree too large.
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(40 + 4 * 8, 0)), std::runtime_error);
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(120 + 2 * 8, 100)), std::runtime_error);  // Label offset out of range.
+    CHECK_THROWS_AS(BinaryTree(write_corrupt(120 + 2 * 8, 0)), std::runtime_error);  // Decreasing label offsets.
+    std::filesystem::remove(write_corrupt(40, 5));
+}
+
+TEST_CASE("binary_invalid_branch_length", "[regular]") {
+    std::ostringstream out;
+    CHECK_THROWS_AS(to_binary(*parse("(a:x,b);"), out), std::invalid_argument);
+}
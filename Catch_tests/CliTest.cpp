@@ -0,0 +1,122 @@
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+struct Result {
+    int status;
+    std::string out;  // stdout only; stderr is discarded.
+};
+
+/*
+ * Run the newick executable with `arguments`, which are passed through the shell.
+ */
+static Result newick(const std::string& arguments) {
+    const std::string command {std::string(NEWICK_EXECUTABLE) + " " + arguments + " 2>/dev/null"};
+    FILE* pipe {popen(command.c_str(), "r")};
+    REQUIRE(pipe != nullptr);
+    std::string out;
+    std::array<char, 4096> buffer {};
+    while (const std::size_t n {std::fread(buffer.data(), 1, buffer.size(), pipe)}) {
+        out.append(buffer.data(), n);
+    }
+    const int status {pclose(pipe)};
+    return Result {WIFEXITED(status) ? WEXITSTATUS(status) : -1, out};
+}
+
+/*
+ * A fresh path in the temporary directory.
+ */
+static std::filesystem::path temp_path(const std::string& name) {
+    const auto path {std::filesystem::temp_directory_path() / ("newick_cli_test_" + name)};
+    std::filesystem::remove(path);
+    return path;
+}
+
+/*
+ * Write `content` to a fresh temporary file.
+ */
+static std::filesystem::path write_temp(const std::string& name, const std::string& content) {
+    const auto path {temp_path(name)};
+    std::ofstream(path) << content;
+    return path;
+}
+
+TEST_CASE("cli output to file", "[regular]") {
+    const auto path {temp_path("out.phy")};
+    const Result result {newick("distances -s '(a:1,b:2);' -o " + path.string())};
+    CHECK(result.status == 0);
+    CHECK(result.out.empty());
+    std::ifstream in {path};
+    const std::string written {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    CHECK(written == "2\na 0 3\nb 3 0\n");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("cli output to unwritable file", "[regular]") {
+    CHECK(newick("distances -s '(a:1,b:2);' -o /nonexistent/dir/x.phy").status == 1);
+    CHECK(newick("binarise -s '(a,b,c);' -o /nonexistent/dir/x.nwk").status == 1);
+    if (std::filesystem::exists("/dev/full")) {  // Writes fail with ENOSPC.
+        CHECK(newick("generate --trees 1000 --tips 100 -o /dev/full").status == 1);
+    }
+}
+
+TEST_CASE("cli convert reports invalid branch lengths", "[regular]") {
+    const auto path {temp_path("invalid.nwkb")};
+    CHECK(newick("convert -s '(a:x,b);' -o " + path.string()).status == 1);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("cli binarise keeps labels with whitespace quoted", "[regular]") {
+    const Result result {newick("binarise -s \"('Pan troglodytes',c,d);\"")};
+    CHECK(result.status == 0);
+    CHECK(result.out == "('Pan troglodytes',(c,d));\n");
+}
+
+TEST_CASE("cli sample indexed nexus", "[regular]") {
+    const auto path {write_temp("trees.nex", "#NEXUS\nBEGIN TREES;\n  TRANSLATE 1 a, 2 'b c';\n"
+                                             "  TREE t1 = [&R] (1,2);\n  TREE t2 = (2,1);\nEND;\n")};
+    std::filesystem::remove(path.string() + ".idx");
+    const std::string translated {"(a,'b c');\n('b c',a);\n"};
+    CHECK(newick("sample -f " + path.string() + " --translate").out == translated);
+    const Result indexed {newick("index " + path.string())};
+    CHECK(indexed.status == 0);
+    CHECK(indexed.out.starts_with("2 trees"));
+    CHECK(newick("sample -f " + path.string()).out == "(1,2);\n(2,1);\n");
+    CHECK(newick("sample -f " + path.string() + " --translate").out == translated);
+    CHECK(newick("sample -f " + path.string() + " --translate --burnin 1").out == "('b c',a);\n");
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".idx");
+}
+
+TEST_CASE("cli uniq translates nexus and writes to file", "[regular]") {
+    const auto input {write_temp("uniq.nex", "#NEXUS\nBEGIN TREES;\n  TRANSLATE 1 a, 2 b, 3 c, 4 d;\n"
+                                              "  TREE t1 = ((1,2),(3,4));\n  TREE t2 = ((3,4),(2,1));\n"
+                                              "  TREE t3 = ((1,3),(2,4));\nEND;\n")};
+    const auto path {temp_path("uniq.txt")};
+    const Result result {newick("uniq -f " + input.string() + " -o " + path.string())};
+    CHECK(result.status == 0);
+    CHECK(result.out.empty());
+    std::ifstream in {path};
+    const std::string written {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    CHECK(written == "2\t((a,b),(c,d));\n1\t((a,c),(b,d));\n");
+    std::filesystem::remove(input);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("cli rename writes nothing for malformed input", "[regular]") {
+    const auto map {write_temp("names.tsv", "a\tx\nb\ty\n")};
+    const Result renamed {newick("rename --map " + map.string() + " -s '(a,b)c;(b,a);'")};
+    CHECK(renamed.status == 0);
+    CHECK(renamed.out == "(x,y)c;\n(y,x);\n");
+    // The first tree is fine, the second one is not.
+    const Result malformed {newick("rename --map " + map.string() + " -s '(a,b)c;(b,(a);'")};
+    CHECK(malformed.status == 1);
+    CHECK(malformed.out.empty());
+    std::filesystem::remove(map);
+}
@@ -0,0 +1,119 @@
+/*
+ * Asymptotic complexity regression tests.
+ *
+ * We time each operation on trees with n, 2n, 4n and 8n tips and fail if the running time
+ * grows faster than O(n log n) - with generous slack for noise and cache effects, which is
+ * still far below the factor 64 a quadratic algorithm shows.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "node.h"
+#include "parser.h"
+
+static constexpr double SLACK { 2.0 };
+static constexpr int REPETITIONS { 3 };
+
+// Computes the seconds one run of an operation takes on the tree passed as Newick string.
+using Timing = std::function<double(const std::string&)>;
+
+template <typename Function>
+static double timed(Function&& function) {
+    const auto start { std::chrono::steady_clock::now() };
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void check_n_log_n(const TreeModel model, const unsigned long n, const Timing& timing) {
+    std::vector<double> times;
+    for (const unsigned long tips : {n, 2 * n, 4 * n, 8 * n}) {
+        std::ostringstream newick;
+        TreeGenerator(GeneratorOptions {model, tips, 1, exponential_lengths}).generate().write_newick(newick);
+        double best { INFINITY };
+        for (int i = 0; i < REPETITIONS; i++) {
+            best = std::min(best, timing(newick.str()));
+        }
+        times.push_back(best);
+    }
+    const auto size { static_cast<double>(n) };
+    const double n_log_n_ratio { 8.0 * std::log2(8.0 * size) / std::log2(size) };
+    INFO("model " << model << ", seconds: " << times[0] << " " << times[1] << " " << times[2] << " " << times[3]);
+    CHECK(times.back() / times.front() < SLACK * n_log_n_ratio);
+}
+
+
+TEST_CASE("parse_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        std::unique_ptr<Node> tree;
+        return timed([&] { tree = parse(newick); });
+    }};
+    check_n_log_n(caterpillar, 20000, timing);
+    check_n_log_n(balanced, 20000, timing);
+}
+
+TEST_CASE("to_node_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const NewickString newick_string {newick};
+        std::unique_ptr<Node> tree;
+        return timed([&] { tree = newick_string.to_node(); });
+    }};
+    check_n_log_n(caterpillar, 20000, timing);
+    check_n_log_n(balanced, 20000, timing);
+}
+
+TEST_CASE("traverse_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const auto tree {parse(newick)};
+        return timed([&] { CHECK(tree->traverse().size() > 1); });
+    }};
+    check_n_log_n(caterpillar, 50000, timing);
+    check_n_log_n(balanced, 50000, timing);
+}
+
+TEST_CASE("postorder_traversal_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const auto tree {parse(newick)};
+        return timed([&] { CHECK(tree->postorder_traversal().size() > 1); });
+    }};
+    check_n_log_n(caterpillar, 50000, timing);
+    check_n_log_n(balanced, 50000, timing);
+}
+
+TEST_CASE("to_newick_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const auto tree {parse(newick)};
+        return timed([&] { CHECK(tree->to_newick().size() > 1); });
+    }};
+    check_n_log_n(caterpillar, 20000, timing);
+    check_n_log_n(balanced, 20000, timing);
+}
+
+TEST_CASE("resolve_polytomies_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const auto tree {parse(newick)};
+        return timed([&] { tree->resolve_polytomies(); });
+    }};
+    check_n_log_n(star, 50000, timing);
+    check_n_log_n(balanced, 50000, timing);
+}
+
+/*
+ * The ASCII art of a caterpillar tree has n lines of length O(n), so we can only expect
+ * O(n log n) for balanced trees.
+ */
+TEST_CASE("ascii_art_complexity", "[complexity]") {
+    const Timing timing {[](const std::string& newick) {
+        const auto tree {parse(newick)};
+        return timed([&] { CHECK(tree->ascii_art().size() > 1); });
+    }};
+    check_n_log_n(balanced, 5000, timing);
+}
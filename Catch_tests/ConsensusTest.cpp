@@ -0,0 +1,61 @@
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "consensus.h"
+#include "generate.h"
+#include "parser.h"
+#include "reader.h"
+
+
+static const std::string trees {
+    "((A,B),(C,(D,E)));\n"
+    "((B,A),((D,E),C));\n"
+    "((A,C),(B,(D,E)));\n"
+    "(A,(B,(C,(D,E))));\n"
+};
+
+TEST_CASE("count_splits", "[regular]") {
+    TreeReader reader {trees};
+    const SplitCounts counts {count_splits(reader, 3)};
+    CHECK(counts.trees() == 4);
+    CHECK(counts.get_taxa().size() == 5);
+    // {D,E} in all trees, {C,D,E} in three, {B,D,E} in one.
+    REQUIRE(counts.size() == 3);
+    std::uint64_t total {0};
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        total += counts.count(i);
+    }
+    CHECK(total == 8);
+}
+
+TEST_CASE("Majority-rule and strict consensus", "[regular]") {
+    TreeReader reader {trees};
+    const SplitCounts counts {count_splits(reader)};
+    CHECK(consensus_tree(counts)->to_newick() == "(((D,E)1,C)0.75,A,B);");
+    CHECK(consensus_tree(counts, 1.0)->to_newick() == "((D,E)1,A,B,C);");
+    CHECK_THROWS_AS(consensus_tree(counts, 0.3), std::invalid_argument);
+}
+
+TEST_CASE("Consensus of identical trees is the tree", "[regular]") {
+    const auto tree {TreeGenerator(GeneratorOptions {yule, 200, 11, no_lengths}).generate().to_node()};
+    std::string input;
+    for (int i = 0; i < 100; i++) {
+        input += tree->to_newick() + "\n";
+    }
+    TreeReader reader {input};
+    const SplitCounts counts {count_splits(reader, 4)};
+    CHECK(counts.trees() == 100);
+    CHECK(counts.size() == 197);
+    const auto consensus {consensus_tree(counts)};
+    const TaxonIndex taxa {*tree};
+    CHECK(Splits(*consensus, taxa).size() == 197);
+}
+
+TEST_CASE("count_splits reports malformed trees", "[regular]") {
+    TreeReader reader {"((A,B),(C,D));\n((A,B),(C,D);\n"};
+    CHECK_THROWS_AS(count_splits(reader, 2), std::invalid_argument);
+    TreeReader empty {""};
+    CHECK_THROWS_AS(count_splits(empty), std::runtime_error);
+}
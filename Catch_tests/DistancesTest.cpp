@@ -0,0 +1,78 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "distances.h"
+#include "generate.h"
+#include "lca.h"
+#include "parser.h"
+
+
+TEST_CASE("patristic_distances", "[regular]") {
+    const auto tree { parse(std::string("((a:1,b:2)c:3,d:4,(e:5)f)g;")) };
+    const PatristicDistances distances { *tree };
+    REQUIRE(distances.size() == 4);
+    CHECK(distances.get_tips()[3]->name == "e");
+    CHECK(distances.matrix<double>() == std::vector<double> {
+        0, 3, 8, 9,
+        3, 0, 9, 10,
+        8, 9, 0, 9,
+        9, 10, 9, 0});
+    CHECK(distances.matrix<float>(3) == std::vector<float> {
+        0, 3, 8, 9,
+        3, 0, 9, 10,
+        8, 9, 0, 9,
+        9, 10, 9, 0});
+}
+
+TEST_CASE("patristic_distances_random", "[regular]") {
+    const auto tree { TreeGenerator(GeneratorOptions {uniform, 300, 3, exponential_lengths}).generate().to_node() };
+    const PatristicDistances distances { *tree };
+    const LcaIndex lca { *tree };
+    const auto root_distance { [](const Node* node) {
+        double d { 0 };
+        for (; node->get_parent() != nullptr; node = node->get_parent()) {
+            d += node->branch_length_as_float();
+        }
+        return d;
+    } };
+    const auto matrix { distances.matrix<double>(4) };
+    const auto& tips { distances.get_tips() };
+    unsigned long mismatches { 0 };
+    for (std::size_t i = 0; i < tips.size(); i++) {
+        for (std::size_t j = 0; j < tips.size(); j++) {
+            const double expected { root_distance(tips[i]) + root_distance(tips[j])
+                - 2 * root_distance(lca.mrca(tips[i], tips[j])) };
+            mismatches += std::abs(matrix[i * tips.size() + j] - expected) > 1e-9;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("write_distances", "[regular]") {
+    const auto tree { parse(std::string("(a:1,b:2.5);")) };
+    const PatristicDistances distances { *tree };
+    std::ostringstream phylip;
+    write_distances(distances, phylip, DistanceFormat::phylip);
+    CHECK(phylip.str() == "2\na 0 3.5\nb 3.5 0\n");
+    std::ostringstream binary;
+    write_distances(distances, binary, DistanceFormat::float32, 2);
+    CHECK(binary.str().size() == 4 * sizeof(float));
+}
+
+TEST_CASE("write_distances rejects labels PHYLIP cannot represent", "[regular]") {
+    for (const auto* newick : {"(a:1,'b c':2);", "(a:1,:2);"}) {
+        const auto tree { parse(std::string(newick)) };
+        const PatristicDistances distances { *tree };
+        std::ostringstream phylip;
+        CHECK_THROWS_AS(write_distances(distances, phylip, DistanceFormat::phylip), std::invalid_argument);
+        CHECK(phylip.str().empty());
+        std::ostringstream binary;
+        write_distances(distances, binary, DistanceFormat::float64);
+        CHECK(binary.str().size() == 4 * sizeof(double));
+    }
+}
@@ -0,0 +1,107 @@
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "events.h"
+
+
+/*
+ * Records the events as strings.
+ */
+class Recorder : public TreeHandler {
+public:
+    std::vector<std::string> events;
+
+    void on_open() override {
+        events.emplace_back("(");
+    }
+    void on_leaf(const std::string_view label, const std::string_view length) override {
+        events.push_back("leaf " + std::string(label) + ":" + std::string(length));
+    }
+    void on_close(const std::string_view label, const std::string_view length) override {
+        events.push_back(") " + std::string(label) + ":" + std::string(length));
+    }
+    void on_tree_end() override {
+        events.emplace_back(";");
+    }
+};
+
+/*
+ * A streaming transform: doubles all branch lengths.
+ */
+class Doubler : public NewickWriter {
+    std::string number;
+
+public:
+    using NewickWriter::NewickWriter;
+
+    void on_leaf(const std::string_view label, const std::string_view length) override {
+        NewickWriter::on_leaf(label, scale(length));
+    }
+    void on_close(const std::string_view label, const std::string_view length) override {
+        NewickWriter::on_close(label, scale(length));
+    }
+    std::string_view scale(const std::string_view length) {
+        number = length.empty() ? "" : std::to_string(2 * std::stoi(std::string(length)));
+        return number;
+    }
+};
+
+
+TEST_CASE("parse_events", "[regular]") {
+    Recorder recorder;
+    CHECK(!parse_events("((a:1,'b c')c[&x=1],,d);\na;", recorder));
+    CHECK(recorder.events == std::vector<std::string> {
+        "(", "(", "leaf a:1", "leaf 'b c':", ") c:", "leaf :", "leaf d:", ") :", ";", "leaf a:", ";"});
+}
+
+TEST_CASE("parse_events_errors", "[regular]") {
+    Recorder recorder;
+    CHECK(parse_events("(a,b));", recorder)->offset == 5);
+    CHECK(parse_events("((a,b);", recorder)->offset == 6);
+    CHECK(parse_events("(a,b)", recorder)->offset == 5);
+    CHECK(parse_events("(a,b)(c);", recorder)->offset == 5);
+    CHECK(parse_events("(a:,b);", recorder)->offset == 3);
+    CHECK(parse_events("(a:1b,c);", recorder)->offset == 3);
+    CHECK(parse_events("(a,b):x;", recorder)->reason == std::string("invalid branch length"));
+}
+
+TEST_CASE("parse_events_agrees_with_validate", "[regular]") {
+    for (const auto* newick : {"(a:1,b:2.5e-3)c:0;", "(a:1b,c);", "(a:1 2,c);", "(a:-1,b:+1);", "(a,b):x;", "(a:1.,b:.5);"}) {
+        Recorder recorder;
+        const auto error {parse_events(newick, recorder)};
+        CAPTURE(newick);
+        CHECK(error.has_value() == validate(newick).has_value());
+    }
+}
+
+TEST_CASE("newick_writer", "[regular]") {
+    std::ostringstream out;
+    {
+        NewickWriter writer {out};
+        CHECK(!parse_events(" ((a:1,'b c')c[&x=1],,d) ;(e,f)g;", writer));
+    }
+    CHECK(out.str() == "((a:1,'b c')c,,d);\n(e,f)g;\n");
+}
+
+TEST_CASE("streaming_transform", "[regular]") {
+    std::ostringstream out;
+    Doubler doubler {out};
+    CHECK(!parse_events("((a:1,b:2)c:3,d:4);", doubler));
+    doubler.flush();
+    CHECK(out.str() == "((a:2,b:4)c:6,d:8);\n");
+}
+
+TEST_CASE("parse_events_deep", "[regular]") {
+    // Events need no stack, so depth is only limited by the input size.
+    const std::string newick { std::string(1000000, '(') + "a" + std::string(1000000, ')') + ";" };
+    std::ostringstream out;
+    {
+        NewickWriter writer {out};
+        CHECK(!parse_events(newick, writer));
+    }
+    CHECK(out.str() == newick + "\n");
+}
@@ -0,0 +1,49 @@
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "node.h"
+
+
+static std::string newick(const FlatTree& tree) {
+    std::ostringstream out;
+    tree.write_newick(out);
+    return out.str();
+}
+
+TEST_CASE("generate_caterpillar", "[regular]") {
+    TreeGenerator generator {GeneratorOptions {caterpillar, 4, 1, no_lengths}};
+    CHECK(newick(generator.generate()) == "(((t1,t2),t3),t4);");
+}
+
+TEST_CASE("generate_balanced", "[regular]") {
+    TreeGenerator generator {GeneratorOptions {balanced, 4, 1, no_lengths, 1.0, numbered}};
+    CHECK(newick(generator.generate()) == "((1,2),(3,4));");
+}
+
+TEST_CASE("generate_star", "[regular]") {
+    TreeGenerator generator {GeneratorOptions {star, 3, 1, no_lengths}};
+    CHECK(newick(generator.generate()) == "(t1,t2,t3);");
+}
+
+TEST_CASE("generate_reproducible", "[regular]") {
+    for (const auto model : {yule, coalescent, uniform}) {
+        TreeGenerator generator1 {GeneratorOptions {model, 50, 7}};
+        TreeGenerator generator2 {GeneratorOptions {model, 50, 7}};
+        const FlatTree tree { generator1.generate() };
+        CHECK(tree.nodes.size() == 99);
+        CHECK(newick(tree) == newick(generator2.generate()));
+        // Subsequent trees differ.
+        CHECK(newick(tree) != newick(generator1.generate()));
+    }
+}
+
+TEST_CASE("generate_to_node", "[regular]") {
+    TreeGenerator generator {GeneratorOptions {uniform, 20, 3, exponential_lengths}};
+    const FlatTree tree { generator.generate() };
+    const auto node { tree.to_node() };
+    CHECK(node->to_newick() == newick(tree));
+    CHECK(node->traverse().size() == 39);
+}
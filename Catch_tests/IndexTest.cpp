@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "index.h"
+#include "parser.h"
+#include "reader.h"
+
+
+TEST_CASE("find_tree_end", "[regular]") {
+    CHECK(find_tree_end("(a,b)c;(d,e)f;") == 7);
+    CHECK(find_tree_end("(a,b)c;(d,e)f;", 7) == 14);
+    CHECK(find_tree_end("(a,b)c") == std::string_view::npos);
+    // Semicolons in quoted labels and comments do not terminate trees.
+    CHECK(find_tree_end("('a;b',c[;])d;") == 14);
+    CHECK(find_tree_end("('it''s;',c)d;x;") == 14);
+    CHECK(find_tree_end("('a;b,c)d;") == std::string_view::npos);
+}
+
+TEST_CASE("tree_index", "[regular]") {
+    const TreeIndex index { std::string_view("(a,b)c;\n (d,e)f;\n\n") };
+    REQUIRE(index.size() == 2);
+    CHECK(index[0].offset == 0);
+    CHECK(index[0].length == 7);
+    CHECK(index[1].offset == 9);
+    CHECK(index[1].length == 7);
+
+    // Like TreeReader, trailing input without `;` is a last tree.
+    const std::string_view data {"(a,b)c;\n(d,e)f\n"};
+    const TreeIndex trailing {data};
+    REQUIRE(trailing.size() == 2);
+    CHECK(trailing[1].offset == 8);
+    CHECK(trailing[1].length == 7);
+    CHECK(TreeReader(data).count() == 2);
+
+    // In NEXUS files, only the Newick strings of TREE statements are trees.
+    const std::string_view nexus {"#NEXUS\nBEGIN TREES;\n  TRANSLATE 1 a, 2 b;\n"
+                                  "  TREE t1 = [&R] (1,2);\n  TREE t2 = (2,1);\nEND;\n"};
+    const TreeIndex nexus_index {nexus};
+    REQUIRE(nexus_index.size() == 2);
+    CHECK(nexus.substr(nexus_index[0].offset, nexus_index[0].length) == "(1,2);");
+    CHECK(nexus.substr(nexus_index[1].offset, nexus_index[1].length) == "(2,1);");
+}
+
+TEST_CASE("indexed_tree_file", "[regular]") {
+    const auto path { (std::filesystem::temp_directory_path() / "newick_index_test.nwk").string() };
+    {
+        std::ofstream out(path);
+        for (int i = 0; i < 10; i++) {
+            out << "(a,b)t" << i << ";\n";
+        }
+    }
+    TreeIndex(MappedFile(path).view()).save(index_filename(path));
+    const IndexedTreeFile file { path };
+    REQUIRE(file.size() == 10);
+    CHECK(file.newick(3) == "(a,b)t3;");
+    CHECK(file.tree(9)->name == "t9");
+    const auto trees { file.trees(1, 10, 4) };
+    REQUIRE(trees.size() == 3);
+    CHECK(trees[2]->name == "t9");
+
+    // A stale index is ignored.
+    std::ofstream(path, std::ios::app) << "(a,b)t10;\n";
+    CHECK(IndexedTreeFile(path).size() == 11);
+
+    // Also if the file keeps its size.
+    TreeIndex(MappedFile(path).view(), modification_time(path)).save(index_filename(path));
+    const auto time {std::filesystem::last_write_time(path)};
+    const auto size {std::filesystem::file_size(path)};
+    std::ofstream(path) << std::string(size - 1, ' ') << ";";
+    std::filesystem::last_write_time(path, time + std::chrono::seconds(1));
+    CHECK(IndexedTreeFile(path).size() == 1);
+    std::filesystem::remove(path);
+    std::filesystem::remove(index_filename(path));
+}
+
+/*
+ * Write an index file for a 100 byte file with `n` trees at `offset`, claiming `claimed` trees.
+ */
+static void write_index(const std::string& path, const std::uint64_t n, const std::uint64_t claimed,
+                        const std::uint64_t offset) {
+    std::ofstream out(path, std::ios::binary);
+    const std::uint64_t header[4] {2, 100, 0, claimed};
+    out.write("NWKI", 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof header);
+    for (std::uint64_t i = 0; i < n; i++) {
+        const TreeOffset tree {offset, 10};
+        out.write(reinterpret_cast<const char*>(&tree), sizeof tree);
+    }
+}
+
+TEST_CASE("tree_index_invalid", "[regular]") {
+    const auto path { (std::filesystem::temp_directory_path() / "newick_index_test.idx").string() };
+    write_index(path, 2, 2, 90);
+    CHECK(TreeIndex::load(path).size() == 2);
+    write_index(path, 2, 3, 0);  // Truncated.
+    CHECK_THROWS_AS(TreeIndex::load(path), std::runtime_error);
+    write_index(path, 2, (1ULL << 60) + 2, 0);  // The size of the offsets overflows to that of 2.
+    CHECK_THROWS_AS(TreeIndex::load(path), std::runtime_error);
+    write_index(path, 2, 2, 91);  // Beyond the end of the indexed file.
+    CHECK_THROWS_AS(TreeIndex::load(path), std::runtime_error);
+    write_index(path, 1, 1, UINT64_MAX);
+    CHECK_THROWS_AS(TreeIndex::load(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
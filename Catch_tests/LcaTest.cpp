@@ -0,0 +1,79 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "lca.h"
+#include "parser.h"
+
+
+/*
+ * MRCA by walking up from both nodes.
+ */
+static Node* naive_mrca(Node* a, Node* b) {
+    std::vector<Node*> path {a};
+    for (Node* ancestor : a->ancestors()) {
+        path.push_back(ancestor);
+    }
+    for (Node* node = b; node != nullptr; node = node->get_parent()) {
+        for (Node* candidate : path) {
+            if (candidate == node) {
+                return node;
+            }
+        }
+    }
+    return nullptr;
+}
+
+
+TEST_CASE("lca_index", "[regular]") {
+    const auto tree { parse(std::string("((a,b)c,(d,(e,f)g)h)i;")) };
+    const LcaIndex lca { *tree };
+    const auto nodes { tree->traverse() };  // i c a b h d g e f
+    CHECK(lca.mrca(nodes[2], nodes[3])->name == "c");
+    CHECK(lca.mrca(nodes[3], nodes[2])->name == "c");
+    CHECK(lca.mrca(nodes[2], nodes[8])->name == "i");
+    CHECK(lca.mrca(nodes[5], nodes[8])->name == "h");
+    CHECK(lca.mrca(nodes[6], nodes[7])->name == "g");  // Ancestor and descendant.
+    CHECK(lca.mrca(nodes[4], nodes[4])->name == "h");
+    CHECK(lca.mrca({nodes[7], nodes[5], nodes[8]})->name == "h");
+    CHECK(lca.mrca({nodes[7]})->name == "e");
+
+    const auto other { parse(std::string("(a,b);")) };
+    CHECK_THROWS_AS(lca.mrca(nodes[2], other.get()), std::invalid_argument);
+    CHECK_THROWS_AS(lca.mrca(std::vector<const Node*> {}), std::invalid_argument);
+}
+
+TEST_CASE("lca_index_modifications", "[regular]") {
+    const auto tree { parse(std::string("(((a)b,c)d,e)f;")) };
+    const LcaIndex lca { *tree };
+    const Node* c { tree->get_children()[0]->get_children()[1].get() };
+    const Node* e { tree->get_children()[1].get() };
+    CHECK(lca.mrca(c, e) == tree.get());
+    tree->remove_redundant_nodes();  // Removes node b.
+    CHECK_THROWS_AS(lca.mrca(c, e), std::logic_error);
+    CHECK_THROWS_AS(lca.mrca({c, e}), std::logic_error);
+}
+
+TEST_CASE("lca_index_single_node", "[regular]") {
+    const auto tree { parse(std::string("a;")) };
+    const LcaIndex lca { *tree };
+    CHECK(lca.mrca(tree.get(), tree.get()) == tree.get());
+}
+
+TEST_CASE("lca_index_random", "[regular]") {
+    for (const TreeModel model : {yule, uniform, caterpillar}) {
+        const auto tree { TreeGenerator(GeneratorOptions {model, 500, 7}).generate().to_node() };
+        const LcaIndex lca { *tree };
+        const auto nodes { tree->traverse() };
+        unsigned long mismatches { 0 };
+        for (std::size_t i = 0; i < nodes.size(); i += 7) {
+            for (std::size_t j = 0; j < nodes.size(); j += 13) {
+                mismatches += lca.mrca(nodes[i], nodes[j]) != naive_mrca(nodes[i], nodes[j]);
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
@@ -1,3 +1,7 @@
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include "parser.h"
@@ -19,3 +23,65 @@ TEST_CASE("NewickString from tokens", "[category?]"){
     }
     CHECK(NewickString(tokens).get_min_level() == 1);
 }
+
+TEST_CASE("NewickString with quoted labels and comments", "[category?]"){
+    NewickString ns { "('a,(b)'[&x=(1,2)],c)d;" };
+    CHECK(ns.tokens[1].type == QWORD);
+    CHECK(ns.tokens[9].type == COMMENT);
+    CHECK(ns.get_descendants().size() == 2);
+    CHECK(ns.to_node()->get_children()[0]->name == "a,(b)");
+}
+
+TEST_CASE("validate", "[category?]"){
+    CHECK(!validate(""));
+    CHECK(!validate("(a,b)c;\n((a:1,'b;c':2.5e-3)[&x=1]:0.1,,d)e;"));
+    CHECK(!validate(" ( a b : 1 ,\n c ) d ;\n"));
+
+    const auto check { [](const std::string_view input, const std::size_t offset, const std::string_view reason) {
+        const auto error { validate(input) };
+        REQUIRE(error);
+        CHECK(error->offset == offset);
+        CHECK(error->reason == reason);
+    } };
+    check("((a,b),c;", 8, "unbalanced '('");
+    check("(a,b));", 5, "unbalanced ')'");
+    check("a,b;", 1, "',' outside of braces");
+    check("(a,b)c", 6, "missing ';'");
+    check("(a,b);(c,d)", 11, "missing ';'");
+    check("(a:,b);", 3, "missing branch length");
+    check("(a:x,b);", 3, "invalid branch length");
+    check("(a:1:2,b);", 4, "unexpected ':'");
+    check("(a,'b)c;", 3, "unclosed quote");
+    check("(a,b[c)d;", 4, "unclosed comment");
+    check("(a,b]c);", 4, "unexpected ']'");
+    check("(a,b'c');", 4, "unexpected quote");
+    check("('a'b,c);", 4, "unexpected label");
+    check("(a,b)(c,d);", 5, "unexpected '('");
+}
+
+TEST_CASE("try_parse", "[category?]"){
+    const auto tree { try_parse("(a,b)c;") };
+    REQUIRE(tree);
+    CHECK((*tree)->to_newick() == "(a,b)c;");
+
+    const auto error { try_parse("(a,b))c;") };
+    REQUIRE(!error);
+    CHECK(error.error().offset == 5);
+    CHECK(std::string_view(error.error().reason) == "unbalanced ')'");
+    CHECK(!try_parse("(a,b)c"));  // Missing `;`.
+}
+
+TEST_CASE("parse_errors", "[category?]"){
+    CHECK_THROWS_AS(parse(std::string("(a,b))c;")), std::invalid_argument);
+    CHECK_THROWS_AS(parse(std::string("((a,b)c;")), std::invalid_argument);
+    CHECK_THROWS_AS(parse(std::string("(a,'b)c;")), std::invalid_argument);
+    CHECK_THROWS_AS(NewickString("(a,b))c;"), std::invalid_argument);
+}
+
+TEST_CASE("leaf_labels", "[category?]"){
+    CHECK(leaf_labels("((a:1,b [&x=1])c:2, 'd,e' ,)f;(g,h);")
+        == std::vector<std::string_view> {"a", "b", "'d,e'"});
+    CHECK(leaf_labels("a;") == std::vector<std::string_view> {"a"});
+    CHECK(leaf_labels("(a b,[c]\nd)").size() == 2);
+    CHECK(leaf_labels("").empty());
+}
@@ -0,0 +1,68 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "nexus.h"
+#include "parser.h"
+
+static const std::string NEXUS {R"(#NEXUS
+[ written by BEAST; trees; ]
+BEGIN TAXA;
+    DIMENSIONS NTAX = 3;
+END;
+Begin trees;
+    Translate
+        1 Homo_sapiens,
+        2 'Pan troglodytes',
+        3 'O''Brien'
+        ;
+    tree STATE_0 = [&R] ((1:0.1,2:0.2):0.3,3:0.4);
+    TREE STATE_1000 [&lnP=-12.5] = [&U] ((1,3),2);
+End;
+)"};
+
+
+TEST_CASE("nexus_reader", "[regular]") {
+    NexusReader reader {NEXUS};
+    CHECK(reader.get_taxa() == std::vector<std::string> {"", "Homo_sapiens", "Pan troglodytes", "O'Brien"});
+    CHECK(reader.next_newick() == "((1:0.1,2:0.2):0.3,3:0.4);");
+    const auto tree {reader.next()};
+    CHECK(tree->to_newick() == "((1,3),2);");
+    CHECK(reader.next() == nullptr);
+    CHECK(NexusReader(NEXUS).count() == 2);
+}
+
+TEST_CASE("nexus_translate", "[regular]") {
+    NexusReader reader {NEXUS};
+    CHECK(reader.taxon_id("2") == 2);
+    CHECK(reader.taxon_id("4") == -1);
+    CHECK(reader.taxon_id("x") == -1);
+    CHECK(reader.taxon("3") == "O'Brien");
+    CHECK(reader.taxon("x") == "x");
+    const auto tree {reader.next()};
+    reader.translate(*tree);
+    CHECK(tree->to_newick() == "((Homo_sapiens:0.1,'Pan troglodytes':0.2):0.3,'O''Brien':0.4);");
+}
+
+TEST_CASE("nexus_without_trees", "[regular]") {
+    CHECK(NexusReader("#NEXUS\nBEGIN TAXA;\nEND;\n").count() == 0);
+    CHECK_THROWS_AS(NexusReader("#NEXUS\nBEGIN TREES;\nTRANSLATE a b;\nEND;"), std::runtime_error);
+    // Ids index the table, so huge ids must not size it.
+    CHECK_THROWS_AS(NexusReader("#NEXUS\nBEGIN TREES;\nTRANSLATE 1000000000000 a;\nEND;"), std::runtime_error);
+    CHECK(NexusReader("#NEXUS\nBEGIN TREES;\nTRANSLATE 0 a, 2 b;\nEND;").get_taxa().size() == 3);
+}
+
+TEST_CASE("make_reader", "[regular]") {
+    CHECK(is_nexus("  #nexus\n"));
+    CHECK(!is_nexus("(a,b)c;"));
+    CHECK(make_reader(NEXUS)->count() == 2);
+    CHECK(make_reader("(a,b)c; (d,e)f;")->count() == 2);
+}
+
+TEST_CASE("unquote", "[regular]") {
+    CHECK(unquote("'O''Brien'") == "O'Brien");
+    CHECK(unquote("abc") == "abc");
+    CHECK(unquote("''") == "");
+}
@@ -0,0 +1,73 @@
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "node_index.h"
+#include "parser.h"
+
+
+TEST_CASE("node_index", "[regular]") {
+    const auto tree { parse(std::string("((a,b)c,(d,e,f)g,)root;")) };
+    const NodeIndex index { *tree };
+    CHECK(index.size() == 8);
+    CHECK(index.find("root") == tree.get());
+    CHECK(index.find("c") == tree->get_children()[0].get());
+    CHECK(index.find("e") == tree->get_children()[1]->get_children()[1].get());
+    CHECK(index.find("x") == nullptr);
+    CHECK(index.find("") == nullptr);
+    CHECK(index.get_duplicates().empty());
+}
+
+TEST_CASE("node_index_duplicates", "[regular]") {
+    const auto tree { parse(std::string("((a,b)a,(b,a)c);")) };
+    const NodeIndex index { *tree };
+    CHECK(index.size() == 3);
+    CHECK(index.find("a") == tree->get_children()[0].get());  // First in preorder.
+    CHECK(index.get_duplicates() == std::vector<std::string_view> {"a", "b"});
+}
+
+TEST_CASE("node_index_modifications", "[regular]") {
+    const auto tree { parse(std::string("(((a,b,c)d)e,f)g;")) };
+    NodeIndex index { *tree };
+    tree->resolve_polytomies();  // Keeps the index valid.
+    CHECK(index.find("a")->name == "a");
+    tree->remove_redundant_nodes();
+    CHECK_THROWS_AS(index.find("a"), std::logic_error);
+    index.rebuild();
+    CHECK(index.find("e") == nullptr);
+    CHECK(index.find("d") == tree->get_children()[0].get());
+}
+
+TEST_CASE("node_index_move_assignment", "[regular]") {
+    const auto tree { parse(std::string("((a,b)c,d)e;")) };
+    const NodeIndex index { *tree };
+    *tree = std::move(*parse(std::string("(x,y)z;")));  // Destroys all indexed nodes.
+    CHECK_THROWS_AS(index.find("a"), std::logic_error);
+
+    const auto other { parse(std::string("((a,b)c,d)e;")) };
+    const NodeIndex other_index { *other };
+    const Node moved { std::move(*other->get_children()[0]) };  // Takes a and b out of the tree.
+    CHECK(moved.get_children().size() == 2);
+    CHECK_THROWS_AS(other_index.find("a"), std::logic_error);
+}
+
+TEST_CASE("node_index_subtree_modifications", "[regular]") {
+    const auto tree { parse(std::string("(((a)b,c)d,e)f;")) };
+    const NodeIndex index { *tree };
+    tree->get_children()[0]->remove_redundant_nodes();  // Removes node b, below the root.
+    CHECK_THROWS_AS(index.find("c"), std::logic_error);
+}
+
+TEST_CASE("node_index_large", "[regular]") {
+    std::string newick { "(" };
+    for (int i = 0; i < 100000; i++) {
+        newick += (i ? ",t" : "t") + std::to_string(i);
+    }
+    const auto tree { parse(newick + ");") };
+    const NodeIndex index { *tree };
+    CHECK(index.size() == 100000);
+    CHECK(index.find("t99999") == tree->get_children().back().get());
+}
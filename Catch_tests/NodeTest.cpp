@@ -145,3 +145,110 @@ TEST_CASE("print_ascii_6", "[regular]") {
   CHECK(lines[8] == "    └c───┼rr");
   CHECK(lines[9] == "         └tt");
 };
+
+TEST_CASE("deep_tree", "[regular]") {
+  // Deep trees must not exhaust the call stack when parsed, formatted or destroyed.
+  std::string newick { std::string(200000, '(') + "a" };
+  for (int i = 0; i < 200000; i++) {
+    newick.append(",b)");
+  }
+  std::unique_ptr<Node> node { parse(newick) };
+  CHECK(node->traverse().size() == 400001);
+  CHECK(node->to_newick() == newick + ";");
+};
+
+TEST_CASE("parse_whitespace", "[regular]") {
+  std::unique_ptr<Node> node { parse(std::string(" ( a b : 1 ,\n c ) d ;\n")) };
+  CHECK(node->to_newick() == "('a b':1,c)d;");
+};
+
+TEST_CASE("parse_quoted_labels", "[regular]") {
+  std::unique_ptr<Node> node { parse(std::string("('a, (b)':1,'O''Brien','x;y')'[c]';")) };
+  CHECK(node->get_children()[0]->name == "a, (b)");
+  CHECK(node->get_children()[0]->branch_length == "1");
+  CHECK(node->get_children()[1]->name == "O'Brien");
+  CHECK(node->get_children()[2]->name == "x;y");
+  CHECK(node->name == "[c]");
+  CHECK(node->to_newick() == "('a, (b)':1,'O''Brien','x;y')'[c]';");
+
+  // Whitespace is not kept verbatim outside quotes, so labels containing it are quoted.
+  node = parse(std::string("('Pan troglodytes','a\tb','c\nd',e);"));
+  CHECK(node->to_newick() == "('Pan troglodytes','a\tb','c\nd',e);");
+  CHECK(parse(node->to_newick())->get_children()[0]->name == "Pan troglodytes");
+};
+
+TEST_CASE("needs_quotes", "[regular]") {
+  CHECK(!needs_quotes("Homo_sapiens"));
+  CHECK(!needs_quotes(""));
+  for (const auto* label : {"a,b", "a(b", "a)", "[a]", "O'Brien", "a:1", "a;", "a b", "a\tb", "a\n", "a\r"}) {
+    CHECK(needs_quotes(label));
+  }
+  std::string newick;
+  append_label(newick, "O'Brien");
+  append_label(newick, "x");
+  CHECK(newick == "'O''Brien'x");
+};
+
+TEST_CASE("parse_comments", "[regular]") {
+  const std::string newick { "[&R] (a[&rate=0.1]:1[&length=1],b:2[x,(y)])c[&height=3];" };
+  std::unique_ptr<Node> node { parse(newick) };
+  CHECK(node->to_newick() == "(a:1,b:2)c;");
+
+  std::vector<Comment> comments;
+  node = parse(newick, comments);
+  REQUIRE(comments.size() == 5);
+  CHECK(comments[0].node == node.get());
+  CHECK(comments[0].text == "&R");
+  CHECK(comments[1].node == node->get_children()[0].get());
+  CHECK(comments[1].text == "&rate=0.1");
+  CHECK(comments[2].text == "&length=1");
+  CHECK(comments[3].node == node->get_children()[1].get());
+  CHECK(comments[3].text == "x,(y)");
+  CHECK(comments[4].node == node.get());
+  CHECK(comments[4].text == "&height=3");
+};
+
+/*
+ * Check that each node is the parent of its children.
+ */
+static bool consistent_parents(Node& tree) {
+  for (const Node* node : tree.traverse()) {
+    for (const auto& child : node->get_children()) {
+      if (child->get_parent() != node) {
+        return false;
+      }
+    }
+  }
+  return tree.get_parent() == nullptr;
+}
+
+TEST_CASE("parent_links", "[regular]") {
+  std::unique_ptr<Node> node { parse(std::string("((a,b,c)d,(e)f)g;")) };
+  CHECK(consistent_parents(*node));
+  Node* a { node->get_children()[0]->get_children()[0].get() };
+  std::vector<std::string> names;
+  for (const Node* ancestor : a->ancestors()) {
+    names.push_back(ancestor->name);
+  }
+  CHECK(names == std::vector<std::string> {"d", "g"});
+  CHECK(node->ancestors().begin() == node->ancestors().end());
+
+  const auto siblings { a->siblings() };
+  REQUIRE(siblings.size() == 2);
+  CHECK(siblings[0]->name == "b");
+  CHECK(siblings[1]->name == "c");
+  CHECK(node->siblings().empty());
+
+  node->resolve_polytomies();
+  CHECK(consistent_parents(*node));
+  node->remove_redundant_nodes();
+  CHECK(consistent_parents(*node));
+  CHECK(node->get_children()[1]->name == "e");
+};
+
+TEST_CASE("parent_links_move", "[regular]") {
+  std::unique_ptr<Node> node { parse(std::string("((a,b)c,d)e;")) };
+  Node moved { std::move(*node->get_children()[0]) };
+  CHECK(moved.get_parent() == nullptr);
+  CHECK(moved.get_children()[0]->get_parent() == &moved);
+};
@@ -0,0 +1,44 @@
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "profile.h"
+
+
+TEST_CASE("profile_phases", "[regular]") {
+    Profile profile;
+    const int result { profile.measure("compute", [] { return 42; }) };
+    profile.measure("noop", [] {});
+    CHECK(result == 42);
+    REQUIRE(profile.get_phases().size() == 2);
+    CHECK(profile.get_phases()[0].name == "compute");
+    CHECK(profile.get_phases()[1].name == "noop");
+    CHECK(profile.get_phases()[0].wall_seconds >= 0.0);
+}
+
+TEST_CASE("profile_nested_phases", "[regular]") {
+    Profile profile;
+    profile.measure("outer", [&profile] {
+        profile.measure("inner", [] {});
+        profile.measure("inner2", [] {});
+    });
+    const auto& phases { profile.get_phases() };
+    REQUIRE(phases.size() == 3);
+    CHECK(phases[0].name == "outer");
+    CHECK(phases[0].depth == 0);
+    CHECK(phases[1].depth == 1);
+    CHECK(phases[2].depth == 1);
+    // The outer phase includes the inner ones, which are not counted again in the total.
+    CHECK(phases[0].wall_seconds >= phases[1].wall_seconds + phases[2].wall_seconds);
+    CHECK(profile.wall_seconds() == phases[0].wall_seconds);
+    CHECK(profile.to_text().find("\n  inner ") != std::string::npos);
+}
+
+TEST_CASE("profile_json", "[regular]") {
+    Profile profile;
+    profile.trees = 3;
+    profile.measure("parse", [] {});
+    const std::string json { profile.to_json() };
+    CHECK(json.starts_with("{\"phases\": [{\"name\": \"parse\""));
+    CHECK(json.find("\"trees\": 3") != std::string::npos);
+}
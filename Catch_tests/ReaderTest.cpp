@@ -0,0 +1,71 @@
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "reader.h"
+
+
+TEST_CASE("tree_reader", "[regular]") {
+    TreeReader reader { "(a,b)c;\n('x;y',[;]z)w;\n(d,e)f;\n" };
+    CHECK(reader.next()->name == "c");
+    CHECK(reader.skip());
+    CHECK(reader.next_newick() == "(d,e)f;");
+    CHECK(!reader.skip());
+    CHECK(reader.next() == nullptr);
+}
+
+TEST_CASE("tree_reader_count", "[regular]") {
+    CHECK(TreeReader("(a,b)c; (d,e)f; (g,h)i;").count() == 3);
+    CHECK(TreeReader("").count() == 0);
+}
+
+TEST_CASE("burnin_trees", "[regular]") {
+    CHECK(burnin_trees("10%", 200) == 20);
+    CHECK(burnin_trees("15", 200) == 15);
+    CHECK(burnin_trees("", 200) == 0);
+    CHECK_THROWS_AS(burnin_trees("150%", 200), std::invalid_argument);
+}
+
+TEST_CASE("sample_trees", "[regular]") {
+    std::string input;
+    for (int i = 0; i < 10; i++) {
+        input += "(a,b)t" + std::to_string(i) + ";";
+    }
+    TreeReader reader { input };
+    std::vector<std::string> sampled;
+    sample_trees(reader, 2, 3, [&sampled](const std::string_view newick) { sampled.emplace_back(newick); });
+    CHECK(sampled == std::vector<std::string> {"(a,b)t2;", "(a,b)t5;", "(a,b)t8;"});
+}
+
+TEST_CASE("parse_batch", "[regular]") {
+    TreeReader reader { "(a,b)c;\n(a,b))c;\n(d,e)f;\n(g,h" };
+    std::vector<std::string> trees;
+    std::vector<std::pair<std::size_t, std::size_t>> errors;
+    const std::size_t n { parse_batch(reader,
+        [&trees](Node& tree) { trees.push_back(tree.to_newick()); },
+        [&errors](const std::size_t i, const ParseError& error) { errors.emplace_back(i, error.offset); }) };
+    CHECK(n == 2);
+    CHECK(trees == std::vector<std::string> {"(a,b)c;", "(d,e)f;"});
+    CHECK(errors == std::vector<std::pair<std::size_t, std::size_t>> {{1, 13}, {3, 29}});
+}
+
+TEST_CASE("parse_parallel", "[regular]") {
+    std::string input;
+    for (int i = 0; i < 1000; i++) {
+        input += "(a,b)t" + std::to_string(i) + ";\n";
+    }
+    TreeReader reader { input };
+    std::vector<std::vector<std::string>> names(4);
+    parse_parallel(reader, 4, [&names](const unsigned thread, std::string_view, Node& tree) { names[thread].push_back(tree.name); });
+    std::size_t total { 0 };
+    for (const auto& thread_names : names) {
+        total += thread_names.size();
+    }
+    CHECK(total == 1000);
+
+    TreeReader malformed { "(a,b)c;\n(a,b))c;\n" };
+    CHECK_THROWS_AS(parse_parallel(malformed, 2, [](unsigned, std::string_view, Node&) {}), std::invalid_argument);
+}
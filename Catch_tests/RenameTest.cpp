@@ -0,0 +1,51 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "rename.h"
+
+
+TEST_CASE("label_map", "[regular]") {
+    const LabelMap map { "a\tHomo sapiens\r\nb\tPan\n\nc\tO'Brien\nb\tGorilla" };
+    CHECK(map.size() == 3);
+    CHECK(map.find("a") == "'Homo sapiens'");  // Quoted like labels written by Node.
+    CHECK(map.find("b") == "Gorilla");  // Later lines win.
+    CHECK(map.find("c") == "'O''Brien'");
+    CHECK(!map.find("d"));
+    CHECK(!map.find(""));
+    CHECK_THROWS_AS(LabelMap("a b\n"), std::runtime_error);
+}
+
+TEST_CASE("label_map_large", "[regular]") {
+    std::string tsv;
+    for (int i = 0; i < 100000; i++) {
+        tsv += "t" + std::to_string(i) + "\tx" + std::to_string(i) + "\n";
+    }
+    const LabelMap map { tsv };
+    CHECK(map.size() == 100000);
+    CHECK(map.find("t0") == "x0");
+    CHECK(map.find("t99999") == "x99999");
+    CHECK(!map.find("t100000"));
+}
+
+TEST_CASE("renamer", "[regular]") {
+    const LabelMap map { "a\tx\nb\ty,z\nc\tinner\n" };
+    std::ostringstream out;
+    {
+        Renamer renamer {out, map};
+        CHECK(!parse_events("((a:1,'b'),d)c;\n(a,b);", renamer));
+    }
+    CHECK(out.str() == "((x:1,'y,z'),d)c;\n(x,'y,z');\n");
+}
+
+TEST_CASE("renamer_flush", "[regular]") {
+    const LabelMap map { "a\tx\n" };
+    std::ostringstream out;
+    Renamer renamer {out, map};
+    renamer.on_open();
+    renamer.on_leaf("a", "1");
+    renamer.flush();  // The events are still in the prefetch window.
+    CHECK(out.str() == "(x:1");
+}
@@ -0,0 +1,75 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "parser.h"
+#include "rf.h"
+
+
+TEST_CASE("RF distances of small trees", "[regular]") {
+    RobinsonFoulds rf;
+    rf.add(*parse("((A,B),(C,(D,E)));"));
+    rf.add(*parse("(((E,D),C),(B,A));"));  // Same topology.
+    rf.add(*parse("((A,C),(B,(D,E)));"));
+    rf.add(*parse("(A,B,C,D,E);"));  // Star tree, no splits.
+    REQUIRE(rf.size() == 4);
+    CHECK(rf.splits(0) == 2);
+    CHECK(rf.splits(3) == 0);
+    CHECK(rf.distinct_splits() == 3);
+    CHECK(rf.distance(0, 1) == 0);
+    CHECK(rf.distance(0, 2) == 2);
+    CHECK(rf.distance(2, 0) == 2);
+    CHECK(rf.distance(0, 3) == 2);
+    CHECK(rf.normalized_distance(0, 2) == 0.5);
+    CHECK(rf.normalized_distance(0, 3) == 1.0);
+    CHECK(rf.normalized_distance(3, 3) == 0.0);
+}
+
+TEST_CASE("RF of single-tip trees", "[regular]") {
+    RobinsonFoulds rf;
+    rf.add(*parse("a;"));
+    rf.add(*parse("a;"));
+    CHECK(rf.distance(0, 1) == 0);
+}
+
+TEST_CASE("RF rejects trees on other taxa", "[regular]") {
+    RobinsonFoulds rf;
+    rf.add(*parse("((A,B),(C,D));"));
+    CHECK_THROWS_AS(rf.add(*parse("((A,B),(C,E));")), std::invalid_argument);
+    CHECK_THROWS_AS(rf.add(*parse("((A,B),C);")), std::invalid_argument);
+    CHECK(rf.size() == 1);
+}
+
+TEST_CASE("RF matrix rows match pairwise distances", "[regular]") {
+    RobinsonFoulds rf;
+    TreeGenerator generator {GeneratorOptions {yule, 40, 3}};
+    for (int i = 0; i < 300; i++) {  // More trees than a tile.
+        rf.add(*generator.generate().to_node());
+    }
+    const std::size_t n {rf.size()};
+    std::vector<float> matrix(n * n);
+    rf.rows(0, n, matrix.data(), 3);
+    std::size_t mismatches {0};
+    for (std::size_t i = 0; i < n; i++) {
+        CHECK(rf.splits(i) == 37);
+        for (std::size_t j = 0; j < n; j++) {
+            if (matrix[i * n + j] != static_cast<float>(rf.distance(i, j)) || rf.distance(i, j) != rf.distance(j, i)) {
+                mismatches++;
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("write_rf", "[regular]") {
+    RobinsonFoulds rf {true};
+    rf.add(*parse("((A,B),(C,D));"));
+    rf.add(*parse("((A,C),(B,D));"));
+    std::ostringstream phylip;
+    write_rf(rf, phylip, DistanceFormat::phylip);
+    CHECK(phylip.str() == "2\n1 0 1\n2 1 0\n");
+}
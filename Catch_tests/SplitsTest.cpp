@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "parser.h"
+#include "splits.h"
+
+
+/*
+ * The splits as sets of labels, for comparison.
+ */
+static std::set<std::set<std::string>> label_sets(const Splits& splits, const TaxonIndex& taxa) {
+    std::set<std::set<std::string>> result;
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        std::set<std::string> side;
+        for (std::uint32_t t = 0; t < taxa.size(); t++) {
+            if (splits.contains(i, t)) {
+                side.insert(taxa.label(t));
+            }
+        }
+        result.insert(side);
+    }
+    return result;
+}
+
+TEST_CASE("TaxonIndex numbers tips in preorder", "[regular]") {
+    const auto tree {parse("((A,B),(C,D));")};
+    TaxonIndex taxa {*tree};
+    CHECK(taxa.size() == 4);
+    CHECK(taxa.label(0) == "A");
+    CHECK(taxa.find("D") == 3);
+    CHECK(!taxa.find("E"));
+    CHECK(taxa.add("C") == 2);
+    CHECK(taxa.add("E") == 4);
+}
+
+TEST_CASE("Splits are nontrivial and normalized", "[regular]") {
+    const auto tree {parse("((A,B),(C,(D,E)));")};
+    const TaxonIndex taxa {*tree};
+    const Splits splits {*tree, taxa};
+    // (A,B) and (C,D,E) are the same bipartition, normalized to the side without A.
+    CHECK(label_sets(splits, taxa) == std::set<std::set<std::string>> {{"C", "D", "E"}, {"D", "E"}});
+    CHECK(splits.words_per_split() == 1);
+}
+
+TEST_CASE("Splits do not depend on rooting or child order", "[regular]") {
+    const auto a {parse("((A,B),(C,(D,E)),F);")};
+    const auto b {parse("(((E,D),C),F,(B,A));")};
+    const TaxonIndex taxa {*a};
+    const Splits sa {*a, taxa};
+    const Splits sb {*b, taxa};
+    REQUIRE(sa.size() == 3);
+    CHECK(label_sets(sa, taxa) == label_sets(sb, taxa));
+    std::set<std::pair<std::uint64_t, std::uint64_t>> ha, hb;
+    for (std::size_t i = 0; i < sa.size(); i++) {
+        ha.emplace(sa.hash(i).low, sa.hash(i).high);
+        hb.emplace(sb.hash(i).low, sb.hash(i).high);
+        CHECK(sa.hash(i) == hash_split(sa.split(i)));
+    }
+    CHECK(ha == hb);
+}
+
+TEST_CASE("Splits span several words", "[regular]") {
+    const auto tree {TreeGenerator(GeneratorOptions {yule, 300, 7}).generate().to_node()};
+    const TaxonIndex taxa {*tree};
+    const Splits splits {*tree, taxa};
+    CHECK(splits.words_per_split() == 5);
+    // A binary tree on n taxa has n - 3 nontrivial bipartitions.
+    CHECK(splits.size() == 297);
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        CHECK_FALSE(splits.contains(i, 0));
+        CHECK((splits.split(i)[4] >> (300 % 64)) == 0);
+    }
+}
+
+TEST_CASE("Splits reject unknown and duplicate taxa", "[regular]") {
+    const TaxonIndex taxa {*parse("((A,B),(C,D));")};
+    CHECK_THROWS_AS(Splits(*parse("((A,B),(C,E));"), taxa), std::invalid_argument);
+    CHECK_THROWS_AS(Splits(*parse("((A,B),(C,A));"), taxa), std::invalid_argument);
+}
+
+TEST_CASE("Splits of trees covering part of the taxa", "[regular]") {
+    const TaxonIndex taxa {*parse("(A,B,C,D,E);")};
+    // Without A, the two sides of the root are one bipartition, normalized to the side without B.
+    const auto tree {parse("((B,C),(D,E));")};
+    const Splits splits {*tree, taxa};
+    CHECK(splits.tips() == 4);
+    CHECK(label_sets(splits, taxa) == std::set<std::set<std::string>> {{"D", "E"}});
+    // Splits with a single taxon on one side of the tree's own taxa are trivial.
+    CHECK(Splits(*parse("((B,C),D);"), taxa).size() == 0);
+}
+
+TEST_CASE("Splits of a single-tip tree", "[regular]") {
+    const auto tree {parse("a;")};
+    const TaxonIndex taxa {*tree};
+    REQUIRE(taxa.size() == 1);
+    const Splits splits {*tree, taxa};
+    CHECK(splits.tips() == 1);
+    CHECK(splits.size() == 0);
+}
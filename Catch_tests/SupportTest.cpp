@@ -0,0 +1,48 @@
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "parser.h"
+#include "reader.h"
+#include "support.h"
+
+
+static const std::string trees {
+    "((A,B),(C,(D,E)));\n"
+    "((B,A),((D,E),C));\n"
+    "((A,C),(B,(D,E)));\n"
+    "(A,(B,(C,(D,E))));\n"
+};
+
+TEST_CASE("SplitSupport counts the splits of the reference", "[regular]") {
+    const auto reference {parse("((A,C),((B,D),E));")};
+    SplitSupport support {*reference};
+    REQUIRE(support.get_splits().size() == 2);
+    TreeReader reader {trees};
+    support.add(reader, 3);
+    CHECK(support.trees() == 4);
+    // {A,C} (i.e. {B,D,E}) is in one tree, {B,D} in none.
+    CHECK(support.count(0) + support.count(1) == 1);
+    support.annotate();
+    CHECK(reference->to_newick() == "((A,C)0.25,((B,D)0,E)0.25);");
+}
+
+TEST_CASE("SplitSupport labels both children of a bifurcating root", "[regular]") {
+    const auto reference {parse("((A,B),(C,(D,E)));")};
+    SplitSupport support {*reference};
+    for (const auto* newick : {"((A,B),(C,(D,E)));", "((A,C),(B,(D,E)));"}) {
+        support.add(*parse(newick));
+    }
+    support.annotate();
+    CHECK(reference->to_newick() == "((A,B)0.5,(C,(D,E)1)0.5);");
+}
+
+TEST_CASE("SplitSupport rejects trees on other taxa", "[regular]") {
+    const auto reference {parse("((A,B),(C,D));")};
+    SplitSupport support {*reference};
+    CHECK_THROWS_AS(support.add(*parse("((A,B),(C,E));")), std::invalid_argument);
+    CHECK_THROWS_AS(support.add(*parse("((A,B),C);")), std::invalid_argument);
+    TreeReader reader {"((A,B),(C,D));\n((A,B),(C,D)\n"};
+    CHECK_THROWS_AS(support.add(reader, 2), std::invalid_argument);
+}
@@ -0,0 +1,69 @@
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "generate.h"
+#include "parser.h"
+#include "reader.h"
+#include "tree_hash.h"
+
+
+static TreeHash hash_of(const std::string& newick, const TreeHashOptions& options = {}) {
+    return canonical_hash(*parse(newick), options);
+}
+
+TEST_CASE("canonical_hash ignores the order of children", "[regular]") {
+    CHECK(hash_of("((A,B),(C,(D,E)));") == hash_of("(((E,D),C),(B,A));"));
+    CHECK(hash_of("((A,B),C,D);") == hash_of("(D,C,(B,A));"));
+    CHECK_FALSE(hash_of("((A,B),(C,(D,E)));") == hash_of("((A,C),(B,(D,E)));"));
+    // Rooted trees: the same unrooted tree with another root hashes differently.
+    CHECK_FALSE(hash_of("((A,B),(C,D));") == hash_of("(A,(B,(C,D)));"));
+    CHECK_FALSE(hash_of("((A,B),C);") == hash_of("((A,B,C));"));
+}
+
+TEST_CASE("canonical_hash options", "[regular]") {
+    const TreeHashOptions shape {false};
+    CHECK_FALSE(hash_of("((A,B),(C,D));") == hash_of("((A,C),(B,D));"));
+    CHECK(hash_of("((A,B),(C,D));", shape) == hash_of("((A,C),(B,D));", shape));
+    CHECK_FALSE(hash_of("((A,B),(C,D));", shape) == hash_of("(((A,B),C),D);", shape));
+
+    CHECK(hash_of("((A,B)x,C);") == hash_of("((A,B)y,C);"));
+    CHECK_FALSE(hash_of("((A,B)x,C);", TreeHashOptions {true, true}) == hash_of("((A,B)y,C);", TreeHashOptions {true, true}));
+
+    const TreeHashOptions lengths {true, false, true, 2};
+    CHECK(hash_of("((A:1,B:2):0.5,C:1.5);") == hash_of("((A:1,B:2):0.7,C:1.5);"));
+    CHECK(hash_of("((A:1,B:2):0.5,C:1.5);", lengths) == hash_of("(C:1.5,(B:2.001,A:1):0.5);", lengths));
+    CHECK_FALSE(hash_of("((A:1,B:2):0.5,C:1.5);", lengths) == hash_of("((A:1,B:2):0.7,C:1.5);", lengths));
+}
+
+TEST_CASE("canonical_hash is stable", "[regular]") {
+    // Pinned, as hashes may key persistent caches: labels are read as little-endian words on
+    // all platforms, and the value must not change between builds.
+    const TreeHash h {hash_of("((Homo_sapiens,Pan),(Gorilla,Pongo));")};
+    CHECK(h.low == 0x72d195a5382a6baeULL);
+    CHECK(h.high == 0xf2acacc9d7db6a0fULL);
+}
+
+TEST_CASE("canonical_hash of deep trees", "[regular]") {
+    const auto tree {TreeGenerator(GeneratorOptions {caterpillar, 100000, 1}).generate().to_node()};
+    CHECK(canonical_hash(*tree) == canonical_hash(*parse(tree->to_newick())));
+}
+
+TEST_CASE("count_topologies", "[regular]") {
+    TreeReader reader {
+        "((A,B),(C,D));\n"
+        "((A,C),(B,D));\n"
+        "((D,C),(B,A));\n"
+        "((C,A),(D,B));\n"
+        "((A,D),(B,C));\n"
+        "((B,A),(C,D));\n"
+    };
+    const auto counts {count_topologies(reader, {}, 3)};
+    REQUIRE(counts.size() == 3);
+    CHECK(counts[0].count == 3);
+    CHECK(counts[0].newick == "((A,B),(C,D));");
+    CHECK(counts[1].count == 2);
+    CHECK(counts[1].newick == "((A,C),(B,D));");
+    CHECK(counts[2].count == 1);
+    CHECK(counts[2].offset == 60);
+}
@@ -0,0 +1,199 @@
+/*
+ * Benchmarks for the core tree operations on synthetic trees.
+ *
+ * Run e.g. `newick_bench --benchmark_filter='parse/caterpillar'`. Throughput is reported as
+ * `bytes_per_second` (size of the Newick input) and `nodes/s`.
+ */
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "events.h"
+#include "generate.h"
+#include "node.h"
+#include "parser.h"
+
+
+/*
+ * Create a Newick string for a tree of the given shape with (about) `nodes` nodes.
+ */
+static std::string make_newick(const TreeModel model, const unsigned long nodes) {
+    const unsigned long tips { nodes < 3 ? 2 : (model == star ? nodes - 1 : (nodes + 1) / 2) };
+    std::ostringstream newick;
+    TreeGenerator(GeneratorOptions {model, tips, 42, exponential_lengths}).generate().write_newick(newick);
+    return newick.str();
+}
+
+/*
+ * Newick inputs are expensive to create for the larger sizes, so we cache them.
+ */
+static const std::vector<char>& corpus(const TreeModel shape, const unsigned long nodes) {
+    static std::map<std::pair<TreeModel, unsigned long>, std::vector<char>> cache;
+    const auto key { std::make_pair(shape, nodes) };
+    if (!cache.contains(key)) {
+        const std::string newick { make_newick(shape, nodes) };
+        cache.emplace(key, std::vector<char>(newick.begin(), newick.end()));
+    }
+    return cache.at(key);
+}
+
+static void report(benchmark::State& state, const std::vector<char>& input, const unsigned long nodes) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+    state.counters["nodes"] = static_cast<double>(nodes);
+    state.counters["nodes/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * nodes), benchmark::Counter::kIsRate);
+}
+
+
+static void BM_parse(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    unsigned long nodes { 0 };
+    for (auto _ : state) {
+        auto tree { parse(input) };
+        benchmark::DoNotOptimize(tree);
+        state.PauseTiming();
+        nodes = tree->traverse().size();
+        tree.reset();  // Destroy the tree outside the timed region.
+        state.ResumeTiming();
+    }
+    report(state, input, nodes);
+}
+
+/*
+ * Event-driven parse, without building nodes.
+ */
+static void BM_parse_events(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    TreeHandler handler;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_events(std::string_view(input.data(), input.size()), handler));
+    }
+    report(state, input, static_cast<unsigned long>(state.range(0)));
+}
+
+/*
+ * Parse trees annotated like BEAST output, where most of the input is comments.
+ */
+static void BM_parse_annotated(benchmark::State& state, const TreeModel shape) {
+    std::vector<char> input;
+    for (const char c : corpus(shape, static_cast<unsigned long>(state.range(0)))) {
+        if (c == ':') {
+            const std::string_view comment { "[&rate=0.0123,height_95%_HPD={1.2345,2.3456}]" };
+            input.insert(input.end(), comment.begin(), comment.end());
+        }
+        input.push_back(c);
+    }
+    unsigned long nodes { 0 };
+    for (auto _ : state) {
+        auto tree { parse(input) };
+        benchmark::DoNotOptimize(tree);
+        state.PauseTiming();
+        nodes = tree->traverse().size();
+        tree.reset();
+        state.ResumeTiming();
+    }
+    report(state, input, nodes);
+}
+
+static void BM_to_newick(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    const auto tree { parse(input) };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree->to_newick());
+    }
+    report(state, input, tree->traverse().size());
+}
+
+static void BM_ascii_art(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    const auto tree { parse(input) };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree->ascii_art());
+    }
+    report(state, input, tree->traverse().size());
+}
+
+static void BM_postorder_traversal(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    const auto tree { parse(input) };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree->postorder_traversal());
+    }
+    report(state, input, tree->traverse().size());
+}
+
+static void BM_traverse(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    const auto tree { parse(input) };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree->traverse());
+    }
+    report(state, input, tree->traverse().size());
+}
+
+/*
+ * Mutating operations need a fresh tree per iteration, which we parse outside the timed region.
+ */
+static void BM_remove_redundant_nodes(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    unsigned long nodes { 0 };
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tree { parse(input) };
+        nodes = tree->traverse().size();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(tree->remove_redundant_nodes());
+        state.PauseTiming();
+        tree.reset();
+        state.ResumeTiming();
+    }
+    report(state, input, nodes);
+}
+
+static void BM_resolve_polytomies(benchmark::State& state, const TreeModel shape) {
+    const auto& input { corpus(shape, static_cast<unsigned long>(state.range(0))) };
+    unsigned long nodes { 0 };
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tree { parse(input) };
+        nodes = tree->traverse().size();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(tree->resolve_polytomies());
+        state.PauseTiming();
+        tree.reset();
+        state.ResumeTiming();
+    }
+    report(state, input, nodes);
+}
+
+
+static constexpr long MIN_NODES { 10 };
+static constexpr long MAX_NODES { 10'000'000 };
+
+#define NEWICK_BENCHMARK(func, max_nodes) \
+    BENCHMARK_CAPTURE(func, balanced, balanced)->RangeMultiplier(10)->Range(MIN_NODES, max_nodes); \
+    BENCHMARK_CAPTURE(func, caterpillar, caterpillar)->RangeMultiplier(10)->Range(MIN_NODES, max_nodes); \
+    BENCHMARK_CAPTURE(func, star, star)->RangeMultiplier(10)->Range(MIN_NODES, max_nodes); \
+    BENCHMARK_CAPTURE(func, random, uniform)->RangeMultiplier(10)->Range(MIN_NODES, max_nodes)
+
+NEWICK_BENCHMARK(BM_parse, MAX_NODES);
+NEWICK_BENCHMARK(BM_parse_events, MAX_NODES);
+NEWICK_BENCHMARK(BM_parse_annotated, 1'000'000);
+NEWICK_BENCHMARK(BM_to_newick, MAX_NODES);
+// The ASCII art of a caterpillar tree has quadratic size, so we stop earlier.
+BENCHMARK_CAPTURE(BM_ascii_art, balanced, balanced)->RangeMultiplier(10)->Range(MIN_NODES, 1'000'000);
+BENCHMARK_CAPTURE(BM_ascii_art, caterpillar, caterpillar)->RangeMultiplier(10)->Range(MIN_NODES, 10'000);
+BENCHMARK_CAPTURE(BM_ascii_art, star, star)->RangeMultiplier(10)->Range(MIN_NODES, 1'000'000);
+BENCHMARK_CAPTURE(BM_ascii_art, random, uniform)->RangeMultiplier(10)->Range(MIN_NODES, 1'000'000);
+NEWICK_BENCHMARK(BM_postorder_traversal, MAX_NODES);
+NEWICK_BENCHMARK(BM_traverse, MAX_NODES);
+NEWICK_BENCHMARK(BM_remove_redundant_nodes, MAX_NODES);
+NEWICK_BENCHMARK(BM_resolve_polytomies, MAX_NODES);
+
+BENCHMARK_MAIN();
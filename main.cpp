@@ -1,39 +1,328 @@
+#include <filesystem>
 #include <format>
+#include <fstream>
+#include <functional>
 #include <memory>
+#include <thread>
 #include <iostream>
 #include <vector>
 
+#include "binary.h"
+#include "distances.h"
+#include "rf.h"
+#include "consensus.h"
+#include "support.h"
+#include "tree_hash.h"
+#include "generate.h"
+#include "index.h"
+#include "lca.h"
+#include "nexus.h"
+#include "node_index.h"
 #include "parser.h"
+#include "profile.h"
+#include "rename.h"
+#include "reader.h"
 #include "newick_lib/argparse.hpp"
 #include "newick_lib/util.h"
 
-enum Cmd {
+// Scoped, so that commands don't clash with library functions of the same name.
+enum class Cmd {
     binarise, // 0
     print_ascii, // 1
+    generate, // 2
+    convert, // 3
+    index, // 4
+    sample, // 5
+    validate, // 6
+    rename, // 7
+    leaves, // 8
+    mrca, // 9
+    distances, // 10
+    rf, // 11
+    consensus, // 12
+    support, // 13
+    uniq, // 14
     help,
 };
 
 constexpr Cmd getCmd(const std::string_view sv) {
-    if (sv == "binarise") return binarise;
-    if (sv == "print-ascii") return print_ascii;
-    return help;
+    if (sv == "binarise") return Cmd::binarise;
+    if (sv == "print-ascii") return Cmd::print_ascii;
+    if (sv == "generate") return Cmd::generate;
+    if (sv == "convert") return Cmd::convert;
+    if (sv == "index") return Cmd::index;
+    if (sv == "sample") return Cmd::sample;
+    if (sv == "validate") return Cmd::validate;
+    if (sv == "rename") return Cmd::rename;
+    if (sv == "leaves") return Cmd::leaves;
+    if (sv == "mrca") return Cmd::mrca;
+    if (sv == "distances") return Cmd::distances;
+    if (sv == "rf") return Cmd::rf;
+    if (sv == "consensus") return Cmd::consensus;
+    if (sv == "support") return Cmd::support;
+    if (sv == "uniq") return Cmd::uniq;
+    return Cmd::help;
+}
+
+constexpr TreeModel getModel(const std::string_view sv) {
+    if (sv == "coalescent") return coalescent;
+    if (sv == "uniform") return uniform;
+    if (sv == "caterpillar") return caterpillar;
+    if (sv == "balanced") return balanced;
+    if (sv == "star") return star;
+    return yule;
+}
+
+constexpr BranchLengths getBranchLengths(const std::string_view sv) {
+    if (sv == "none") return no_lengths;
+    if (sv == "exponential") return exponential_lengths;
+    if (sv == "uniform") return uniform_lengths;
+    return model_lengths;
+}
+
+constexpr DistanceFormat getDistanceFormat(const std::string_view sv) {
+    if (sv == "float32") return DistanceFormat::float32;
+    if (sv == "float64") return DistanceFormat::float64;
+    return DistanceFormat::phylip;
+}
+
+constexpr LabelScheme getLabelScheme(const std::string_view sv) {
+    if (sv == "numbered") return numbered;
+    if (sv == "none") return unlabelled;
+    return prefixed;
+}
+
+/*
+ * The input, from the file or string given on the command line, or from stdin.
+ */
+static InputBuffer read_input(const std::string& path, const std::string& string, Profile& profile) {
+    InputBuffer input {profile.measure("read_input", [&path, &string] {
+        return !path.empty() ? InputBuffer::from_file(path)
+            : (!string.empty() ? InputBuffer::from_string(string) : InputBuffer::from_stream(std::cin));
+    })};
+    profile.bytes = input.view().size();
+    return input;
+}
+
+/*
+ * The first tree of the input, with NEXUS taxon ids translated.
+ */
+static std::unique_ptr<Node> read_first_tree(TreeReader& reader, Profile& profile) {
+    std::unique_ptr<Node> tree {profile.measure("parse", [&reader] { return reader.next(); })};
+    if (tree == nullptr) {
+        throw std::runtime_error("no tree in input");
+    }
+    if (const auto* nexus {dynamic_cast<const NexusReader*>(&reader)}) {
+        nexus->translate(*tree);
+    }
+    profile.trees = 1;
+    return tree;
+}
+
+/*
+ * Where results go: the file given with -o, or stdout. Failures to open or write the file
+ * throw std::runtime_error, so call close() once done to detect short writes.
+ */
+class Output {
+    std::string path;
+    std::ofstream file;
+
+public:
+    Output() = default;
+    explicit Output(const std::string& path, const std::ios::openmode mode) : path {path}, file(path, mode) {
+        if (!file) {
+            throw std::runtime_error("cannot open " + path + " for writing");
+        }
+    }
+
+    std::ostream& stream() {
+        return file.is_open() ? file : std::cout;
+    }
+    void close() {
+        stream().flush();
+        if (!stream()) {
+            throw std::runtime_error("error writing " + (path.empty() ? std::string("to stdout") : path));
+        }
+    }
+};
+
+static Output open_output(const std::string& output, const bool binary = false) {
+    if (output.empty()) {
+        return Output {};
+    }
+    return Output {output, binary ? std::ios::out | std::ios::binary : std::ios::out};
+}
+
+static void report_profile(const Profile& profile, const bool profiling, const std::string& format) {
+    if (profiling) {
+        std::cerr << (format == "json" ? profile.to_json() + "\n" : profile.to_text());
+    }
+}
+
+/*
+ * Run a command, reporting exceptions and the profile on stderr. Returns the exit status.
+ */
+static int run_command(const Profile& profile, const bool profiling, const std::string& format,
+                       const std::function<int()>& command) {
+    int status;
+    try {
+        status = command();
+    } catch (const std::exception &err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    report_profile(profile, profiling, format);
+    return status;
 }
 
 int main(int argc, char **argv) {
     argparse::ArgumentParser program("newick");
     std::string cmd;
     program.add_argument("cmd")
-            .help("{binarise, print-ascii}")
-            .choices("binarise", "print-ascii")
+            .help("{binarise, print-ascii, generate, convert, index, sample, validate, rename, leaves, mrca, distances, rf, consensus, support, uniq}")
+            .choices("binarise", "print-ascii", "generate", "convert", "index", "sample", "validate", "rename", "leaves",
+                     "mrca", "distances", "rf", "consensus", "support", "uniq")
             .store_into(cmd);
     std::string path;
     program.add_argument("-f")
             .help("read input from file")
             .default_value("").store_into(path);
+    std::string file;
+    program.add_argument("file")
+            .help("read input from file (same as -f)")
+            .nargs(argparse::nargs_pattern::optional)
+            .default_value("").store_into(file);
     std::string string;
     program.add_argument("-s")
             .help("read input from string argument")
             .default_value("").store_into(string);
+    std::string output;
+    program.add_argument("-o")
+            .help("write output to file")
+            .default_value("").store_into(output);
+    bool profiling { false };
+    program.add_argument("--profile")
+            .help("report time and memory per phase on stderr")
+            .flag().store_into(profiling);
+    std::string profile_format;
+    program.add_argument("--profile-format")
+            .help("{text, json}")
+            .choices("text", "json")
+            .default_value("text").store_into(profile_format);
+
+    // Options for `generate`:
+    std::string model;
+    program.add_argument("--model")
+            .help("{yule, coalescent, uniform, caterpillar, balanced, star}")
+            .choices("yule", "coalescent", "uniform", "caterpillar", "balanced", "star")
+            .default_value("yule").store_into(model);
+    unsigned long tips;
+    program.add_argument("--tips")
+            .help("number of tips of generated trees")
+            .default_value(10UL).store_into(tips);
+    unsigned long trees;
+    program.add_argument("--trees")
+            .help("number of trees to generate")
+            .default_value(1UL).store_into(trees);
+    unsigned long seed;
+    program.add_argument("--seed")
+            .help("seed for the random number generator")
+            .default_value(1UL).store_into(seed);
+    std::string lengths;
+    program.add_argument("--lengths")
+            .help("branch lengths {model, none, exponential, uniform}")
+            .choices("model", "none", "exponential", "uniform")
+            .default_value("model").store_into(lengths);
+    double rate;
+    program.add_argument("--rate")
+            .help("rate of the branch length distribution")
+            .default_value(1.0).store_into(rate);
+    std::string labels;
+    program.add_argument("--labels")
+            .help("tip labels {prefixed, numbered, none}")
+            .choices("prefixed", "numbered", "none")
+            .default_value("prefixed").store_into(labels);
+    std::string prefix;
+    program.add_argument("--prefix")
+            .help("prefix for tip labels")
+            .default_value("t").store_into(prefix);
+
+    bool batch {false};
+    program.add_argument("--batch")
+            .help("binarise or print all trees of the input, reporting and skipping malformed ones")
+            .flag().store_into(batch);
+
+    // Options for `sample`:
+    std::string burnin;
+    program.add_argument("--burnin")
+            .help("number or percentage of trees to skip, e.g. 1000 or 10%")
+            .default_value("0").store_into(burnin);
+    unsigned long every;
+    program.add_argument("--every")
+            .help("keep every n-th tree after the burn-in")
+            .default_value(1UL).store_into(every);
+    bool translate {false};
+    program.add_argument("--translate")
+            .help("replace the taxon ids of NEXUS trees with the names from the TRANSLATE table")
+            .flag().store_into(translate);
+
+    // Options for `rename`:
+    std::string map;
+    program.add_argument("--map")
+            .help("tab-separated file mapping old to new labels")
+            .default_value("").store_into(map);
+
+    // Options for `mrca`:
+    std::string taxa;
+    program.add_argument("--taxa")
+            .help("comma-separated labels of the nodes to find the MRCA of")
+            .default_value("").store_into(taxa);
+    std::string pairs;
+    program.add_argument("--pairs")
+            .help("file with tab-separated pairs of labels to find the MRCA of, one pair per line")
+            .default_value("").store_into(pairs);
+
+    // Options for `distances` and `rf`:
+    std::string format;
+    program.add_argument("--format")
+            .help("output format of the distance matrix")
+            .choices("phylip", "float32", "float64")
+            .default_value("phylip").store_into(format);
+    unsigned long threads;
+    program.add_argument("--threads")
+            .help("number of threads")
+            .default_value(static_cast<unsigned long>(std::max(std::thread::hardware_concurrency(), 1U)))
+            .store_into(threads);
+    bool normalized {false};
+    program.add_argument("--normalized")
+            .help("divide RF distances by the number of splits of both trees")
+            .flag().store_into(normalized);
+
+    // Options for `consensus`:
+    double threshold;
+    program.add_argument("--threshold")
+            .help("minimal frequency of the splits in the consensus tree, 0.5 for majority-rule, 1 for strict")
+            .default_value(0.5).store_into(threshold);
+
+    // Options for `support`:
+    std::string ref;
+    program.add_argument("--ref")
+            .help("file with the reference tree to annotate with the support of its splits")
+            .default_value("").store_into(ref);
+
+    // Options for `uniq`:
+    bool shape {false};
+    program.add_argument("--shape")
+            .help("compare tree shapes only, ignoring tip labels")
+            .flag().store_into(shape);
+    bool with_lengths {false};
+    program.add_argument("--with-lengths")
+            .help("compare branch lengths too, rounded to --digits decimal places")
+            .flag().store_into(with_lengths);
+    int digits;
+    program.add_argument("--digits")
+            .help("decimal places of branch lengths to compare")
+            .default_value(6).store_into(digits);
 
     try {
         program.parse_args(argc, argv);
@@ -42,33 +331,400 @@ int main(int argc, char **argv) {
         std::cerr << program;
         return 1;
     }
-    // Read input from file, cli arg or stdin.
-    std::vector<char> input;
-    if (!path.empty()) {
-        input = read_file(path);
-    } else if (!string.empty()) {
-        input = std::vector<char>(string.begin(), string.end());
-    } else {  // read from stdin
-        std::string input_line;
-        std::getline(std::cin, input_line);
-        input = std::vector<char>(input_line.begin(), input_line.end());
-    }
-    const std::unique_ptr tree {parse(input)};
-
-    switch (getCmd(cmd)) {
-        case binarise:
-            tree->remove_redundant_nodes();
-            tree->resolve_polytomies(); // now we have a binary tree!
-            std::cout << tree->to_newick() << std::endl;
-            break;
-        case print_ascii:
-            for (const auto &line: tree->ascii_art()) {
-                std::cout << line << std::endl;
+    if (path.empty()) {
+        path = file;
+    }
+    Profile profile;
+    if (getCmd(cmd) == Cmd::index) {  // Write the sidecar index for a multi-tree file.
+        if (path.empty()) {
+            std::cerr << "index requires an input file" << std::endl;
+            return 1;
+        }
+        return run_command(profile, profiling, profile_format, [&] {
+            const std::uint64_t time {modification_time(path)};  // Before reading, so later changes show.
+            const MappedFile mapped {profile.measure("map_file", [&path] { return MappedFile(path); })};
+            const TreeIndex tree_index {profile.measure("index", [&mapped, time] { return TreeIndex(mapped.view(), time); })};
+            profile.measure("save_index", [&tree_index, &path] { tree_index.save(index_filename(path)); });
+            profile.bytes = mapped.view().size();
+            profile.trees = tree_index.size();
+            std::cout << tree_index.size() << " trees indexed in " << index_filename(path) << std::endl;
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::sample) {  // Copy selected trees, without parsing them.
+        return run_command(profile, profiling, profile_format, [&] {
+            Output out {open_output(output)};
+            const auto write = [&profile, &out](const std::string_view newick, const NexusReader* nexus) {
+                if (nexus != nullptr) {  // Only translated trees need to be parsed.
+                    const std::unique_ptr<Node> tree {parse(newick)};
+                    nexus->translate(*tree);
+                    out.stream() << tree->to_newick() << "\n";
+                } else {
+                    out.stream() << newick << "\n";
+                }
+                profile.trees++;
             };
-            break;
-        default:
-            // print help
-            break;
+            if (!path.empty() && std::filesystem::exists(index_filename(path))) {
+                const IndexedTreeFile trees {profile.measure("load_index", [&path] { return IndexedTreeFile(path); })};
+                // The index holds the Newick strings of NEXUS trees, the reader their TRANSLATE table.
+                const std::unique_ptr<TreeReader> reader {make_reader(trees.data())};
+                const auto* nexus {translate ? dynamic_cast<const NexusReader*>(reader.get()) : nullptr};
+                profile.measure("sample", [&] {
+                    for (std::size_t i = burnin_trees(burnin, trees.size()); i < trees.size(); i += std::max(every, 1UL)) {
+                        write(trees.newick(i), nexus);
+                    }
+                });
+                out.close();
+                return 0;
+            }
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::size_t skip {burnin.ends_with("%")
+                ? burnin_trees(burnin, profile.measure("count", [&input] { return make_reader(input.view())->count(); }))
+                : burnin_trees(burnin, 0)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const auto* nexus {translate ? dynamic_cast<const NexusReader*>(reader.get()) : nullptr};
+            profile.measure("sample", [&] {
+                sample_trees(*reader, skip, every, [&write, nexus](const std::string_view newick) { write(newick, nexus); });
+            });
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::validate) {  // Check syntax, without building nodes.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const auto error {profile.measure("validate", [&input] { return validate(input.view()); })};
+            if (error) {
+                std::cerr << "error at byte " << error->offset << ": " << error->reason << std::endl;
+                return 1;
+            }
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::rename) {  // Relabel leaves while streaming, without building nodes.
+        if (map.empty()) {
+            std::cerr << "rename requires a mapping file (--map)" << std::endl;
+            return 1;
+        }
+        return run_command(profile, profiling, profile_format, [&] {
+            const MappedFile mapping {profile.measure("map_file", [&map] { return MappedFile(map); })};
+            const LabelMap labels {profile.measure("build_map", [&mapping] { return LabelMap(mapping.view()); })};
+            const InputBuffer input {read_input(path, string, profile)};
+            // Validate first, so that malformed input doesn't leave a truncated tree in the output.
+            if (const auto error {profile.measure("validate", [&input] { return validate(input.view()); })}) {
+                std::cerr << "error at byte " << error->offset << ": " << error->reason << std::endl;
+                return 1;
+            }
+            Output out {open_output(output)};
+            Renamer renamer {out.stream(), labels};
+            const auto error {profile.measure("rename", [&input, &renamer] { return parse_events(input.view(), renamer); })};
+            if (error) {  // validate() and parse_events() agree, so this is a bug.
+                throw std::logic_error("error at byte " + std::to_string(error->offset) + ": " + error->reason);
+            }
+            renamer.flush();
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::leaves) {  // List the tip labels of the first tree, without building nodes.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const auto* nexus {dynamic_cast<const NexusReader*>(reader.get())};
+            Output out {open_output(output)};
+            if (const auto newick {reader->next_newick()}) {
+                const auto labels {profile.measure("leaf_labels", [&newick] { return leaf_labels(*newick); })};
+                profile.measure("write", [&labels, &out, nexus] {
+                    for (const auto label : labels) {
+                        const auto name {nexus != nullptr ? nexus->taxon(label) : label};
+                        if (name.starts_with('\'')) {
+                            out.stream() << unquote(name) << "\n";
+                        } else {
+                            out.stream() << name << "\n";
+                        }
+                    }
+                });
+                profile.trees = 1;
+            }
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::mrca) {  // MRCA queries against the first tree.
+        if (taxa.empty() == pairs.empty()) {
+            std::cerr << "mrca requires either --taxa or --pairs" << std::endl;
+            return 1;
+        }
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const std::unique_ptr<Node> tree {read_first_tree(*reader, profile)};
+            const NodeIndex labels {profile.measure("node_index", [&tree] { return NodeIndex(*tree); })};
+            const LcaIndex lca {profile.measure("lca_index", [&tree] { return LcaIndex(*tree); })};
+            const auto find {[&labels](const std::string_view label) {
+                Node* node {labels.find(label)};
+                if (node == nullptr) {
+                    throw std::runtime_error("no node labelled " + std::string(label));
+                }
+                return node;
+            }};
+            Output out {open_output(output)};
+            if (!taxa.empty()) {
+                std::vector<const Node*> set;
+                for (std::size_t start = 0; start <= taxa.size();) {
+                    const std::size_t end {std::min(taxa.find(',', start), taxa.size())};
+                    set.push_back(find(std::string_view(taxa).substr(start, end - start)));
+                    start = end + 1;
+                }
+                out.stream() << lca.mrca(set)->to_newick() << std::endl;
+                out.close();
+                return 0;
+            }
+            const MappedFile queries {MappedFile(pairs)};
+            profile.measure("mrca", [&] {
+                std::string_view rest {queries.view()};
+                while (!rest.empty()) {
+                    const std::size_t newline {std::min(rest.find('\n'), rest.size())};
+                    std::string_view line {rest.substr(0, newline)};
+                    rest.remove_prefix(std::min(newline + 1, rest.size()));
+                    if (line.ends_with('\r')) {
+                        line.remove_suffix(1);
+                    }
+                    if (line.empty()) {
+                        continue;
+                    }
+                    const std::size_t tab {line.find('\t')};
+                    if (tab == std::string_view::npos) {
+                        throw std::runtime_error("invalid pair: " + std::string(line));
+                    }
+                    out.stream() << line << '\t' << lca.mrca(find(line.substr(0, tab)), find(line.substr(tab + 1)))->name << '\n';
+                }
+            });
+            out.close();
+            return 0;
+        });
+    }
+    const DistanceFormat distance_format {getDistanceFormat(format)};
+    if (getCmd(cmd) == Cmd::distances) {  // Tip-to-tip distance matrix of the first tree.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const std::unique_ptr<Node> tree {read_first_tree(*reader, profile)};
+            const PatristicDistances matrix {profile.measure("prepare", [&tree] { return PatristicDistances(*tree); })};
+            Output out {open_output(output, true)};
+            profile.measure("distances", [&] {
+                write_distances(matrix, out.stream(), distance_format, static_cast<unsigned>(threads));
+            });
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::rf) {  // All-pairs Robinson-Foulds distances of the trees of the input.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const auto* nexus {dynamic_cast<const NexusReader*>(reader.get())};
+            RobinsonFoulds rf {normalized};
+            profile.measure("splits", [&] {
+                while (const std::unique_ptr<Node> tree {reader->next()}) {
+                    if (nexus != nullptr) {
+                        nexus->translate(*tree);
+                    }
+                    rf.add(*tree);
+                }
+            });
+            profile.trees = rf.size();
+            Output out {open_output(output, true)};
+            profile.measure("distances", [&] {
+                write_rf(rf, out.stream(), distance_format, static_cast<unsigned>(threads));
+            });
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::consensus) {  // Consensus tree of the trees of the input.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const SplitCounts counts {profile.measure("count_splits", [&] {
+                return count_splits(*reader, static_cast<unsigned>(threads));
+            })};
+            profile.trees = counts.trees();
+            const std::unique_ptr<Node> tree {profile.measure("consensus", [&] {
+                return consensus_tree(counts, threshold);
+            })};
+            Output out {open_output(output)};
+            out.stream() << tree->to_newick() << std::endl;
+            out.close();
+            return 0;
+        });
     }
-    return 0;
+    if (getCmd(cmd) == Cmd::support) {  // Annotate a reference tree with the support of its splits by the input trees.
+        if (ref.empty()) {
+            std::cerr << "support requires a reference tree (--ref)" << std::endl;
+            return 1;
+        }
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer reference_input {InputBuffer::from_file(ref)};
+            const std::unique_ptr<TreeReader> reference_reader {make_reader(reference_input.view())};
+            const std::unique_ptr<Node> reference {reference_reader->next()};
+            if (reference == nullptr) {
+                throw std::runtime_error("no tree in " + ref);
+            }
+            if (const auto* nexus {dynamic_cast<const NexusReader*>(reference_reader.get())}) {
+                nexus->translate(*reference);
+            }
+            SplitSupport support {*reference};
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            profile.measure("count_splits", [&] { support.add(*reader, static_cast<unsigned>(threads)); });
+            profile.trees = support.trees();
+            support.annotate();
+            Output out {open_output(output)};
+            out.stream() << reference->to_newick() << std::endl;
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::uniq) {  // Count the distinct trees of the input.
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            const TreeHashOptions options {!shape, false, with_lengths, digits};
+            const std::vector<TopologyCount> counts {profile.measure("count_topologies", [&] {
+                return count_topologies(*reader, options, static_cast<unsigned>(threads));
+            })};
+            const auto* nexus {dynamic_cast<const NexusReader*>(reader.get())};
+            Output out {open_output(output)};
+            for (const auto& count : counts) {
+                profile.trees += count.count;
+                out.stream() << count.count << "\t";
+                if (nexus != nullptr) {  // Ids stand for the same taxa in all trees, so only the output is translated.
+                    const std::unique_ptr<Node> tree {parse(count.newick)};
+                    nexus->translate(*tree);
+                    out.stream() << tree->to_newick() << "\n";
+                } else {
+                    out.stream() << count.newick << "\n";
+                }
+            }
+            out.close();
+            return 0;
+        });
+    }
+    if (getCmd(cmd) == Cmd::generate) {  // Write trees directly, without building nodes.
+        return run_command(profile, profiling, profile_format, [&] {
+            TreeGenerator generator {GeneratorOptions {
+                getModel(model), tips, seed, getBranchLengths(lengths), rate, getLabelScheme(labels), prefix}};
+            Output out {open_output(output)};
+            for (unsigned long i = 0; i < trees; i++) {
+                const FlatTree tree {profile.measure("generate", [&generator] { return generator.generate(); })};
+                profile.measure("write_newick", [&tree, &out] {
+                    tree.write_newick(out.stream());
+                    out.stream() << "\n";
+                });
+                profile.nodes += tree.nodes.size();
+            }
+            profile.trees = trees;
+            out.close();
+            return 0;
+        });
+    }
+    bool binary_input {false};
+    if (getCmd(cmd) == Cmd::convert && !path.empty()) {
+        try {
+            binary_input = is_binary(MappedFile(path).view());
+        } catch (const std::exception &err) {
+            std::cerr << err.what() << std::endl;
+            return 1;
+        }
+    }
+    if (binary_input) {  // Binary to Newick.
+        return run_command(profile, profiling, profile_format, [&] {
+            const BinaryTree binary {profile.measure("open_binary", [&path] { return BinaryTree(path); })};
+            const auto tree {profile.measure("to_node", [&binary] { return binary.to_node(); })};
+            const std::string newick {profile.measure("to_newick", [&tree] { return tree->to_newick(); })};
+            Output out {open_output(output)};
+            out.stream() << newick << std::endl;
+            profile.nodes = binary.size();
+            profile.trees = 1;
+            out.close();
+            return 0;
+        });
+    }
+    if (batch && (getCmd(cmd) == Cmd::binarise || getCmd(cmd) == Cmd::print_ascii)) {
+        return run_command(profile, profiling, profile_format, [&] {
+            const InputBuffer input {read_input(path, string, profile)};
+            const std::unique_ptr<TreeReader> reader {make_reader(input.view())};
+            Output out {open_output(output)};
+            const std::size_t errors {profile.measure("batch", [&] {
+                return parse_batch(*reader, [&cmd, &profile, &out](Node& tree) {
+                    if (getCmd(cmd) == Cmd::binarise) {
+                        tree.remove_redundant_nodes();
+                        tree.resolve_polytomies();
+                        out.stream() << tree.to_newick() << "\n";
+                    } else {
+                        for (const auto &line: tree.ascii_art()) {
+                            out.stream() << line << "\n";
+                        }
+                        out.stream() << "\n";
+                    }
+                    profile.trees++;
+                }, [](const std::size_t i, const ParseError& error) {
+                    std::cerr << "tree " << i + 1 << ": error at byte " << error.offset << ": " << error.reason << "\n";
+                });
+            })};
+            out.close();
+            return errors > 0 ? 1 : 0;
+        });
+    }
+    return run_command(profile, profiling, profile_format, [&] {
+        // Read input from file, cli arg or stdin.
+        std::vector<char> input;
+        if (!path.empty()) {
+            input = profile.measure("read_file", [&path] { return read_file(path); });
+        } else if (!string.empty()) {
+            input = std::vector<char>(string.begin(), string.end());
+        } else {  // read from stdin
+            input = profile.measure("read_stdin", [] {
+                std::string input_line;
+                std::getline(std::cin, input_line);
+                return std::vector<char>(input_line.begin(), input_line.end());
+            });
+        }
+        profile.bytes = input.size();
+        const std::unique_ptr<Node> tree {profile.measure("parse", [&input] { return parse(input); })};
+        profile.trees = 1;
+
+        switch (getCmd(cmd)) {
+            case Cmd::binarise: {
+                profile.measure("remove_redundant_nodes", [&tree] { tree->remove_redundant_nodes(); });
+                profile.measure("resolve_polytomies", [&tree] { tree->resolve_polytomies(); }); // now we have a binary tree!
+                Output out {open_output(output)};
+                out.stream() << profile.measure("to_newick", [&tree] { return tree->to_newick(); }) << std::endl;
+                out.close();
+                break;
+            }
+            case Cmd::convert: {  // Newick to binary.
+                Output out {open_output(output, true)};
+                profile.measure("to_binary", [&tree, &out] { to_binary(*tree, out.stream()); });
+                out.close();
+                break;
+            }
+            case Cmd::print_ascii: {
+                Output out {open_output(output)};
+                for (const auto &line: profile.measure("ascii_art", [&tree] { return tree->ascii_art(); })) {
+                    out.stream() << line << std::endl;
+                }
+                out.close();
+                break;
+            }
+            default:
+                // print help
+                break;
+        }
+        if (profiling) {
+            profile.nodes = tree->traverse().size();
+        }
+        return 0;
+    });
 }
@@ -0,0 +1,92 @@
+/*
+ * Replacement global allocation functions feeding the counters in profile.h.
+ *
+ * This file is not part of newick_lib: binaries opt in by linking the `newick_alloc_hooks`
+ * object library, since a program can only have one replacement `operator new`.
+ */
+#include <cstdlib>
+#include <new>
+
+#include "profile.h"
+
+
+void* operator new(const std::size_t size) {
+    count_allocation(size);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Over-aligned types, e.g. alignas(32) hash table slots. aligned_alloc needs a multiple of
+// the alignment as size.
+static void* aligned_malloc(const std::size_t size, const std::align_val_t alignment) {
+    const auto align {static_cast<std::size_t>(alignment)};
+    return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    count_allocation(size);
+    if (void* p = aligned_malloc(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return aligned_malloc(size, alignment);
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,176 @@
+#include <charconv>
+#include <unordered_map>
+
+#include "annotations.h"
+
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\n' || s.front() == '\r')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\n' || s.back() == '\r')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+/*
+ * The value for `key` in a single comment. NHX comments separate `key=value` pairs by `:`,
+ * BEAST comments by `,`, where commas within `{...}` arrays and `"..."` strings don't count.
+ */
+static std::optional<std::string_view> find_value(std::string_view comment, const std::string_view key) {
+    char separator;
+    if (comment.starts_with("&&NHX:")) {
+        comment.remove_prefix(6);
+        separator = ':';
+    } else if (comment.starts_with("&")) {
+        comment.remove_prefix(1);
+        separator = ',';
+    } else {
+        return std::nullopt;
+    }
+    std::size_t start { 0 };
+    int depth { 0 };
+    bool quoted { false };
+    for (std::size_t i = 0; i <= comment.size(); i++) {
+        if (i < comment.size()) {
+            const char c { comment[i] };
+            if (c == '"') {
+                quoted = !quoted;
+            } else if (!quoted && c == '{') {
+                depth++;
+            } else if (!quoted && c == '}') {
+                depth--;
+            }
+            if (quoted || depth > 0 || c != separator) {
+                continue;
+            }
+        }
+        const std::string_view pair { comment.substr(start, i - start) };
+        const std::size_t equals { pair.find('=') };
+        if (equals != std::string_view::npos && trim(pair.substr(0, equals)) == key) {
+            return trim(pair.substr(equals + 1));
+        }
+        start = i + 1;
+    }
+    return std::nullopt;
+}
+
+template<typename T>
+static std::optional<T> to_number(const std::string_view value) {
+    T number {};
+    const auto [p, error] { std::from_chars(value.data(), value.data() + value.size(), number) };
+    if (error != std::errc() || p != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+static std::optional<std::vector<double>> to_array(std::string_view value) {
+    if (!value.starts_with("{") || !value.ends_with("}")) {
+        return std::nullopt;
+    }
+    value = value.substr(1, value.size() - 2);
+    std::vector<double> array;
+    while (!trim(value).empty()) {
+        const std::size_t comma { value.find(',') };
+        const auto number { to_number<double>(trim(value.substr(0, comma))) };
+        if (!number) {
+            return std::nullopt;
+        }
+        array.push_back(*number);
+        value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+    }
+    return array;
+}
+
+
+Annotations::Annotations(const Node& tree, const std::vector<Comment>& comments_)
+{
+    std::unordered_map<const Node*, std::size_t> indices;
+    std::vector<const Node*> stack {&tree};
+    while (!stack.empty()) {  // Preorder, as in Node::traverse.
+        const Node* node { stack.back() };
+        stack.pop_back();
+        indices.emplace(node, nodes.size());
+        nodes.push_back(node);
+        for (auto child = node->get_children().rbegin(); child != node->get_children().rend(); ++child) {
+            stack.push_back(child->get());
+        }
+    }
+    comments.resize(nodes.size());
+    for (const auto& comment : comments_) {
+        const auto index { indices.find(comment.node) };
+        if (index != indices.end()) {
+            comments[index->second].push_back(comment.text);
+        }
+    }
+}
+
+/*
+ * The raw value of `key` for a node. If a node has more than one comment with the key, the
+ * first one wins.
+ */
+std::optional<std::string_view> Annotations::raw_value(const std::size_t node, const std::string_view key) const {
+    for (const auto& comment : comments[node]) {
+        if (const auto value { find_value(comment, key) }) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+const std::vector<std::optional<double>>& Annotations::doubles(const std::string_view key) {
+    if (const auto column { double_columns.find(key) }; column != double_columns.end()) {
+        return column->second;
+    }
+    std::vector<std::optional<double>> column(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        if (const auto value { raw_value(i, key) }) {
+            column[i] = to_number<double>(*value);
+        }
+    }
+    return double_columns.emplace(key, std::move(column)).first->second;
+}
+
+const std::vector<std::optional<long>>& Annotations::ints(const std::string_view key) {
+    if (const auto column { int_columns.find(key) }; column != int_columns.end()) {
+        return column->second;
+    }
+    std::vector<std::optional<long>> column(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        if (const auto value { raw_value(i, key) }) {
+            column[i] = to_number<long>(*value);
+        }
+    }
+    return int_columns.emplace(key, std::move(column)).first->second;
+}
+
+const std::vector<std::optional<std::string_view>>& Annotations::strings(const std::string_view key) {
+    if (const auto column { string_columns.find(key) }; column != string_columns.end()) {
+        return column->second;
+    }
+    std::vector<std::optional<std::string_view>> column(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        if (auto value { raw_value(i, key) }) {
+            if (value->size() >= 2 && value->starts_with("\"") && value->ends_with("\"")) {
+                value = value->substr(1, value->size() - 2);
+            }
+            column[i] = value;
+        }
+    }
+    return string_columns.emplace(key, std::move(column)).first->second;
+}
+
+const std::vector<std::optional<std::vector<double>>>& Annotations::arrays(const std::string_view key) {
+    if (const auto column { array_columns.find(key) }; column != array_columns.end()) {
+        return column->second;
+    }
+    std::vector<std::optional<std::vector<double>>> column(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        if (const auto value { raw_value(i, key) }) {
+            column[i] = to_array(*value);
+        }
+    }
+    return array_columns.emplace(key, std::move(column)).first->second;
+}
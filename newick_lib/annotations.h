@@ -0,0 +1,51 @@
+#ifndef NEWICK_ANNOTATIONS_H
+#define NEWICK_ANNOTATIONS_H
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "node.h"
+#include "parser.h"
+
+/*
+ * Node annotations from NHX comments like `[&&NHX:S=human:B=100]` or BEAST comments like
+ * `[&rate=0.1,height_95%_HPD={1.2,2.3}]`, as columns of typed values, one per node of the
+ * tree in preorder.
+ *
+ * Only the comment spans are kept when the annotations are created. A column is decoded the
+ * first time it is requested, and then cached. Since comments are spans of the parsed input,
+ * the input must outlive the annotations.
+ */
+class Annotations {
+    std::vector<const Node*> nodes;  // In preorder.
+    std::vector<std::vector<std::string_view>> comments;  // Comments per node.
+    std::map<std::string, std::vector<std::optional<double>>, std::less<>> double_columns;
+    std::map<std::string, std::vector<std::optional<long>>, std::less<>> int_columns;
+    std::map<std::string, std::vector<std::optional<std::string_view>>, std::less<>> string_columns;
+    std::map<std::string, std::vector<std::optional<std::vector<double>>>, std::less<>> array_columns;
+
+    [[nodiscard]] std::optional<std::string_view> raw_value(std::size_t node, std::string_view key) const;
+
+public:
+    Annotations(const Node& tree, const std::vector<Comment>& comments);
+
+    /*
+     * The nodes of the tree in preorder, i.e. in the order of the column values.
+     */
+    [[nodiscard]] const std::vector<const Node*>& get_nodes() const {
+        return nodes;
+    }
+    /*
+     * Columns of values for `key`, with std::nullopt for nodes without the key or with a value
+     * which cannot be read as the requested type. Arrays are written as `{1.2,2.3}`.
+     */
+    const std::vector<std::optional<double>>& doubles(std::string_view key);
+    const std::vector<std::optional<long>>& ints(std::string_view key);
+    const std::vector<std::optional<std::string_view>>& strings(std::string_view key);
+    const std::vector<std::optional<std::vector<double>>>& arrays(std::string_view key);
+};
+
+#endif //NEWICK_ANNOTATIONS_H
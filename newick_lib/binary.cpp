@@ -0,0 +1,164 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "binary.h"
+
+
+static std::uint64_t padded(const std::uint64_t n) {
+    return (n + 7) / 8 * 8;
+}
+
+template <typename T>
+static void write_array(std::ostream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+bool is_binary(const std::string_view data) {
+    return data.starts_with(std::string_view("NWKB", 4));
+}
+
+void to_binary(const Node& tree, std::ostream& out) {
+    // Collect nodes in preorder, together with the index of their parent.
+    std::vector<const Node*> nodes;
+    std::vector<std::uint64_t> parents;
+    std::vector<std::pair<const Node*, std::uint64_t>> stack {{&tree, 0}};
+    while (!stack.empty()) {
+        const auto [node, parent] {stack.back()};
+        stack.pop_back();
+        const auto index {static_cast<std::uint64_t>(nodes.size())};
+        nodes.push_back(node);
+        parents.push_back(parent);
+        const auto& children {node->get_children()};
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.emplace_back(child->get(), index);
+        }
+    }
+
+    const std::uint64_t n {nodes.size()};
+    std::vector<std::uint64_t> subtree_sizes(n, 1);
+    for (std::uint64_t i = n - 1; i > 0; i--) {
+        subtree_sizes[parents[i]] += subtree_sizes[i];
+    }
+    std::vector<double> branch_lengths;
+    std::vector<std::uint64_t> label_offsets {0};
+    branch_lengths.reserve(n);
+    label_offsets.reserve(n + 1);
+    for (const Node* node : nodes) {
+        try {
+            branch_lengths.push_back(node->branch_length.empty() ? NAN : node->branch_length_as_float());
+        } catch (const std::logic_error&) {  // From std::stod.
+            throw std::invalid_argument("invalid branch length: " + node->branch_length);
+        }
+        label_offsets.push_back(label_offsets.back() + node->name.size());
+    }
+
+    BinaryHeader header {{'N', 'W', 'K', 'B'}, BINARY_VERSION, n, label_offsets.back(), 0, 0};
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    write_array(out, subtree_sizes);
+    write_array(out, branch_lengths);
+    write_array(out, label_offsets);
+    for (const Node* node : nodes) {
+        out.write(node->name.data(), static_cast<std::streamsize>(node->name.size()));
+    }
+    const std::uint64_t padding {padded(header.label_bytes) - header.label_bytes};
+    out.write("\0\0\0\0\0\0\0", static_cast<std::streamsize>(padding));
+}
+
+
+/*
+ * Offsets into a pool of `bytes` chars must start at 0, not decrease and end at `bytes`.
+ */
+static bool valid_offsets(const std::uint64_t* offsets, const std::uint64_t n, const std::uint64_t bytes) {
+    if (offsets[0] != 0 || offsets[n] != bytes) {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < n; i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BinaryTree::BinaryTree(const std::string& filename)
+    : file {filename}
+{
+    const std::string_view data {file.view()};
+    if (data.size() < sizeof(BinaryHeader) || !is_binary(data)) {
+        throw std::runtime_error(filename + " is not a binary tree file");
+    }
+    header = reinterpret_cast<const BinaryHeader*>(data.data());
+    if (header->version != BINARY_VERSION) {
+        throw std::runtime_error(filename + ": unsupported binary format version");
+    }
+    // Bound the counts by the file size before computing section sizes, so they can't overflow.
+    const std::uint64_t n {header->nodes};
+    const bool has_attributes {(header->flags & BINARY_HAS_ATTRIBUTES) != 0};
+    const std::uint64_t available {data.size() - sizeof(BinaryHeader)};
+    const std::uint64_t arrays {has_attributes ? 4U : 3U};  // Arrays of n (+ 1) words.
+    if (n == 0 || n > available / 8 / arrays
+            || header->label_bytes > available || header->attribute_bytes > available) {
+        throw std::runtime_error(filename + ": truncated binary tree file");
+    }
+    std::uint64_t size {8 * n + 8 * n + 8 * (n + 1) + padded(header->label_bytes)};
+    if (has_attributes) {
+        size += 8 * (n + 1) + padded(header->attribute_bytes);
+    }
+    if (available < size) {
+        throw std::runtime_error(filename + ": truncated binary tree file");
+    }
+    const char* p {data.data() + sizeof(BinaryHeader)};
+    subtree_sizes = reinterpret_cast<const std::uint64_t*>(p);
+    p += 8 * n;
+    branch_lengths = reinterpret_cast<const double*>(p);
+    p += 8 * n;
+    label_offsets = reinterpret_cast<const std::uint64_t*>(p);
+    p += 8 * (n + 1);
+    labels = p;
+    p += padded(header->label_bytes);
+    if (has_attributes) {
+        attribute_offsets = reinterpret_cast<const std::uint64_t*>(p);
+        p += 8 * (n + 1);
+        attributes = p;
+    }
+    if (subtree_sizes[0] != n || !valid_offsets(label_offsets, n, header->label_bytes)
+            || (has_attributes && !valid_offsets(attribute_offsets, n, header->attribute_bytes))) {
+        throw std::runtime_error(filename + ": corrupt binary tree file");
+    }
+    for (std::uint64_t i = 0; i < n; i++) {
+        if (subtree_sizes[i] == 0 || subtree_sizes[i] > n - i) {
+            throw std::runtime_error(filename + ": corrupt binary tree file");
+        }
+    }
+}
+
+std::unique_ptr<Node> BinaryTree::to_node() const {
+    const std::uint64_t n {size()};
+    std::unique_ptr<Node> root;
+    std::vector<std::pair<Node*, std::uint64_t>> open;  // Open nodes and the end of their subtree.
+    char buffer[32];
+    for (std::uint64_t i = 0; i < n; i++) {
+        while (!open.empty() && open.back().second <= i) {
+            open.pop_back();
+        }
+        std::string length;
+        if (!std::isnan(branch_lengths[i])) {
+            length.assign(buffer, std::to_chars(buffer, buffer + sizeof buffer, branch_lengths[i]).ptr);
+        }
+        auto node {std::make_unique<Node>(std::string(label(i)), std::move(length))};
+        Node* pointer {node.get()};
+        if (open.empty()) {
+            root = std::move(node);
+        } else {
+            open.back().first->add_child(std::move(node));
+        }
+        if (subtree_sizes[i] > 1) {
+            open.emplace_back(pointer, i + subtree_sizes[i]);
+        }
+    }
+    return root;
+}
@@ -0,0 +1,89 @@
+#ifndef NEWICK_BINARY_H
+#define NEWICK_BINARY_H
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "node.h"
+#include "util.h"
+
+/*
+ * The .nwkb binary tree format.
+ *
+ * All integers are 64 bit, stored in native (i.e. little endian on all supported platforms)
+ * byte order, and all sections start at multiples of 8 bytes:
+ *
+ * - header (see below)
+ * - subtree sizes: uint64[nodes], nodes in preorder, so the first child of node i is i + 1,
+ *   and the next sibling of node i is i + subtree_size[i].
+ * - branch lengths: float64[nodes], NaN for nodes without branch length.
+ * - label offsets: uint64[nodes + 1], label i is pool[offset[i], offset[i + 1]).
+ * - label pool: char[label_bytes], zero-padded to a multiple of 8.
+ * - optional attribute block, laid out like the labels: uint64[nodes + 1] offsets, followed
+ *   by char[attribute_bytes].
+ */
+struct BinaryHeader {
+    char magic[4];  // "NWKB"
+    std::uint32_t version;
+    std::uint64_t nodes;
+    std::uint64_t label_bytes;
+    std::uint64_t attribute_bytes;
+    std::uint64_t flags;
+};
+
+constexpr std::uint32_t BINARY_VERSION { 1 };
+constexpr std::uint64_t BINARY_HAS_ATTRIBUTES { 1 };
+
+/*
+ * Check whether `data` starts with the magic bytes of the binary format.
+ */
+[[nodiscard]] bool is_binary(std::string_view data);
+
+/*
+ * Write the tree in binary format. Throws std::invalid_argument for non-numeric branch
+ * lengths.
+ */
+void to_binary(const Node& tree, std::ostream& out);
+
+/*
+ * A tree in binary format, read via mmap. Opening a tree checks the header and the subtree
+ * sizes and offsets in one pass, so that corrupt files can't cause out of bounds reads; nodes
+ * are accessed in place.
+ */
+class BinaryTree {
+    MappedFile file;
+    const BinaryHeader* header { nullptr };
+    const std::uint64_t* subtree_sizes { nullptr };
+    const double* branch_lengths { nullptr };
+    const std::uint64_t* label_offsets { nullptr };
+    const char* labels { nullptr };
+    const std::uint64_t* attribute_offsets { nullptr };
+    const char* attributes { nullptr };
+
+public:
+    explicit BinaryTree(const std::string& filename);
+
+    [[nodiscard]] std::uint64_t size() const {
+        return header->nodes;
+    }
+    [[nodiscard]] std::uint64_t subtree_size(const std::uint64_t node) const {
+        return subtree_sizes[node];
+    }
+    [[nodiscard]] double branch_length(const std::uint64_t node) const {
+        return branch_lengths[node];
+    }
+    [[nodiscard]] std::string_view label(const std::uint64_t node) const {
+        return {labels + label_offsets[node], label_offsets[node + 1] - label_offsets[node]};
+    }
+    [[nodiscard]] bool has_attributes() const {
+        return attribute_offsets != nullptr;
+    }
+    [[nodiscard]] std::string_view attribute(const std::uint64_t node) const {
+        return {attributes + attribute_offsets[node], attribute_offsets[node + 1] - attribute_offsets[node]};
+    }
+    [[nodiscard]] std::unique_ptr<Node> to_node() const;
+};
+
+#endif //NEWICK_BINARY_H
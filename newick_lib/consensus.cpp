@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "consensus.h"
+#include "nexus.h"
+
+
+SplitCounts::SplitCounts(TaxonIndex taxa_) : taxa {std::move(taxa_)}, words {(taxa.size() + 63) / 64} {}
+
+void SplitCounts::add(const Node& tree) {
+    const Splits splits {tree, taxa};
+    if (splits.tips() != taxa.size()) {
+        throw std::invalid_argument("tree has different taxa than the first tree");
+    }
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        const std::uint32_t id {table.insert(splits.hash(i))};
+        if (id == counts.size()) {
+            const auto split {splits.split(i)};
+            bits.insert(bits.end(), split.begin(), split.end());
+            counts.push_back(0);
+        }
+        counts[id]++;
+    }
+    tree_count++;
+}
+
+void SplitCounts::merge(const SplitCounts& other) {
+    for (std::size_t i = 0; i < other.size(); i++) {
+        const auto split {other.split(i)};
+        const std::uint32_t id {table.insert(hash_split(split))};
+        if (id == counts.size()) {
+            bits.insert(bits.end(), split.begin(), split.end());
+            counts.push_back(0);
+        }
+        counts[id] += other.counts[i];
+    }
+    tree_count += other.tree_count;
+}
+
+
+SplitCounts count_splits(TreeReader& reader, const unsigned threads) {
+    const auto* nexus {dynamic_cast<const NexusReader*>(&reader)};
+    const std::unique_ptr<Node> first {reader.next()};
+    if (first == nullptr) {
+        throw std::runtime_error("no tree in input");
+    }
+    if (nexus != nullptr) {
+        nexus->translate(*first);
+    }
+    SplitCounts counts {TaxonIndex(*first)};
+    counts.add(*first);
+
+    std::vector<SplitCounts> shards(std::max(threads, 1U), SplitCounts {counts.get_taxa()});
+    parse_parallel(reader, threads, [&shards, nexus](const unsigned thread, std::string_view, Node& tree) {
+        if (nexus != nullptr) {
+            nexus->translate(tree);
+        }
+        shards[thread].add(tree);
+    });
+    for (const SplitCounts& shard : shards) {
+        counts.merge(shard);
+    }
+    return counts;
+}
+
+
+std::unique_ptr<Node> consensus_tree(const SplitCounts& counts, const double threshold) {
+    if (!(threshold >= 0.5 && threshold <= 1.0)) {
+        throw std::invalid_argument("consensus threshold must be between 0.5 and 1");
+    }
+    const std::uint64_t trees {counts.trees()};
+    std::vector<std::pair<std::size_t, std::size_t>> selected;  // Size and index of each split.
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        const std::uint64_t count {counts.count(i)};
+        if (count == trees || static_cast<double>(count) > threshold * static_cast<double>(trees)) {
+            std::size_t size {0};
+            for (const std::uint64_t word : counts.split(i)) {
+                size += static_cast<std::size_t>(std::popcount(word));
+            }
+            selected.emplace_back(size, i);
+        }
+    }
+    // Larger clusters first, so each cluster's parent is the latest node of any of its taxa.
+    // Ties are broken by the bitsets, as the order of the counts depends on thread scheduling.
+    std::ranges::sort(selected, [&counts](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return std::ranges::lexicographical_compare(counts.split(a.second), counts.split(b.second));
+    });
+
+    auto root {std::make_unique<Node>("", "")};
+    const TaxonIndex& taxa {counts.get_taxa()};
+    std::vector<Node*> deepest(taxa.size(), root.get());
+    char number[32];
+    for (const auto& [size, i] : selected) {
+        const auto split {counts.split(i)};
+        const std::size_t first {static_cast<std::size_t>(std::ranges::find_if(split, [](const std::uint64_t word) {
+            return word != 0;
+        }) - split.begin())};
+        Node* const parent {deepest[first * 64 + static_cast<std::size_t>(std::countr_zero(split[first]))]};
+        const double support {static_cast<double>(counts.count(i)) / static_cast<double>(trees)};
+        auto node {std::make_unique<Node>(
+            std::string(number, std::to_chars(number, number + sizeof number, support, std::chars_format::general, 6).ptr), "")};
+        for (std::size_t w = first; w < split.size(); w++) {
+            for (std::uint64_t word = split[w]; word != 0; word &= word - 1) {
+                deepest[w * 64 + static_cast<std::size_t>(std::countr_zero(word))] = node.get();
+            }
+        }
+        parent->add_child(std::move(node));
+    }
+    for (std::uint32_t taxon = 0; taxon < taxa.size(); taxon++) {
+        deepest[taxon]->add_child(std::make_unique<Node>(taxa.label(taxon), ""));
+    }
+    return root;
+}
@@ -0,0 +1,73 @@
+#ifndef NEWICK_CONSENSUS_H
+#define NEWICK_CONSENSUS_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "node.h"
+#include "reader.h"
+#include "splits.h"
+
+/*
+ * Frequencies of the splits of a set of trees on the same taxa. Each distinct split is stored
+ * once, with its bitset and count, so memory grows with the number of distinct splits rather
+ * than the number of trees.
+ */
+class SplitCounts {
+    TaxonIndex taxa;
+    std::size_t words;
+    SplitTable table;
+    std::vector<std::uint64_t> bits;
+    std::vector<std::uint64_t> counts;
+    std::uint64_t tree_count { 0 };
+
+public:
+    explicit SplitCounts(TaxonIndex taxa);
+
+    /*
+     * Count the splits of a tree. Throws std::invalid_argument for trees on other taxa.
+     */
+    void add(const Node& tree);
+    /*
+     * Add the counts of `other`, which must be over the same TaxonIndex.
+     */
+    void merge(const SplitCounts& other);
+
+    [[nodiscard]] const TaxonIndex& get_taxa() const {
+        return taxa;
+    }
+    [[nodiscard]] std::uint64_t trees() const {
+        return tree_count;
+    }
+    [[nodiscard]] std::size_t size() const {
+        return counts.size();
+    }
+    [[nodiscard]] std::uint64_t count(const std::size_t i) const {
+        return counts[i];
+    }
+    [[nodiscard]] std::span<const std::uint64_t> split(const std::size_t i) const {
+        return {bits.data() + i * words, words};
+    }
+};
+
+/*
+ * Count the splits of all remaining trees of `reader`. The taxa are those of the first tree.
+ * Trees are parsed and counted on `threads` threads, each into its own SplitCounts, and the
+ * shards are merged at the end. NEXUS trees are translated. Throws std::invalid_argument for
+ * malformed trees or trees on other taxa, and std::runtime_error if there are no trees.
+ */
+[[nodiscard]] SplitCounts count_splits(TreeReader& reader, unsigned threads = 1);
+
+/*
+ * The consensus tree of the splits found in more than `threshold` of the trees, with the
+ * frequencies of the splits as labels of the inner nodes. A threshold of 0.5 gives the
+ * majority-rule consensus, 1.0 the strict consensus, i.e. splits found in all trees. Below
+ * 0.5 splits may conflict, so the threshold must be in [0.5, 1].
+ *
+ * Splits are clusters in the tree rooted at taxon 0, so taxon 0 is a child of the root.
+ */
+[[nodiscard]] std::unique_ptr<Node> consensus_tree(const SplitCounts& counts, double threshold = 0.5);
+
+#endif //NEWICK_CONSENSUS_H
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "distances.h"
+
+
+PatristicDistances::PatristicDistances(const Node& tree) {
+    std::vector<std::pair<const Node*, std::uint32_t>> stack {{&tree, 0}};  // Nodes and their parents.
+    while (!stack.empty()) {  // Preorder, as in Node::traverse.
+        const auto [node, parent] {stack.back()};
+        stack.pop_back();
+        const auto index {static_cast<std::uint32_t>(entries.size())};
+        const auto tip {static_cast<std::uint32_t>(tips.size())};
+        const double root_distance {index == 0 ? 0.0 : entries[parent].root_distance + node->branch_length_as_float()};
+        const auto& children {node->get_children()};
+        entries.push_back(Entry {parent, tip, children.empty() ? tip + 1 : tip, root_distance});
+        if (children.empty()) {
+            tips.push_back(node);
+            tip_entries.push_back(index);
+            tip_root_distances.push_back(root_distance);
+        }
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.emplace_back(child->get(), index);
+        }
+    }
+    if (tips.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("too many tips");
+    }
+    // Subtrees are contiguous in preorder, so the tip ranges can be closed in reverse.
+    for (std::size_t i = entries.size() - 1; i > 0; i--) {
+        Entry& parent {entries[entries[i].parent]};
+        parent.end_tip = std::max(parent.end_tip, entries[i].end_tip);
+    }
+}
+
+template<typename T>
+void PatristicDistances::row(const std::size_t i, T* out) const {
+    const double* const distances {tip_root_distances.data()};
+    const double own {tip_root_distances[i]};
+    std::uint32_t node {tip_entries[i]};
+    out[i] = 0;
+    while (node != 0) {
+        const Entry& below {entries[node]};
+        const Entry& ancestor {entries[below.parent]};
+        const double offset {own - 2 * ancestor.root_distance};
+        for (std::uint32_t j = ancestor.first_tip; j < below.first_tip; j++) {
+            out[j] = static_cast<T>(offset + distances[j]);
+        }
+        for (std::uint32_t j = below.end_tip; j < ancestor.end_tip; j++) {
+            out[j] = static_cast<T>(offset + distances[j]);
+        }
+        node = below.parent;
+    }
+}
+
+template<typename T>
+void PatristicDistances::rows(const std::size_t first, const std::size_t last, T* out, const unsigned threads) const {
+    if (first >= last) {
+        return;
+    }
+    const std::size_t n {size()};
+    const std::size_t chunk {(last - first + std::max(threads, 1U) - 1) / std::max(threads, 1U)};
+    std::vector<std::thread> workers;
+    for (std::size_t start = first; start < last; start += chunk) {
+        const std::size_t end {std::min(start + chunk, last)};
+        const auto work {[this, start, end, first, n, out] {
+            for (std::size_t i = start; i < end; i++) {
+                row(i, out + (i - first) * n);
+            }
+        }};
+        if (end == last) {
+            work();  // The last chunk runs on the calling thread.
+        } else {
+            workers.emplace_back(work);
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+template<typename T>
+std::vector<T> PatristicDistances::matrix(const unsigned threads) const {
+    std::vector<T> res(size() * size());
+    rows(0, size(), res.data(), threads);
+    return res;
+}
+
+template void PatristicDistances::row<float>(std::size_t, float*) const;
+template void PatristicDistances::row<double>(std::size_t, double*) const;
+template void PatristicDistances::rows<float>(std::size_t, std::size_t, float*, unsigned) const;
+template void PatristicDistances::rows<double>(std::size_t, std::size_t, double*, unsigned) const;
+template std::vector<float> PatristicDistances::matrix<float>(unsigned) const;
+template std::vector<double> PatristicDistances::matrix<double>(unsigned) const;
+
+
+void write_distances(const PatristicDistances& distances, std::ostream& out, const DistanceFormat format,
+                     const unsigned threads) {
+    write_matrix(distances, out, format, threads);
+}
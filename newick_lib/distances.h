@@ -0,0 +1,70 @@
+#ifndef NEWICK_DISTANCES_H
+#define NEWICK_DISTANCES_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "matrix_writer.h"
+#include "node.h"
+
+/*
+ * Patristic (path length) distances between the tips of a tree, from branch lengths.
+ *
+ * Tips, labelled or not, are numbered in preorder, so the tips below any
+ * node form a contiguous range. A row of the matrix is then computed walking up from the tip:
+ * for each ancestor `a`, the tips below `a` but not below the previous node on the path have
+ * distance `root_distance(tip) - 2 * root_distance(a) + root_distance(j)`, which is a simple
+ * loop the compiler vectorizes. A row costs O(n + depth), the matrix O(n^2).
+ */
+class PatristicDistances {
+    struct Entry {  // A node on the path to the root.
+        std::uint32_t parent;
+        std::uint32_t first_tip;  // Range of tips below the node.
+        std::uint32_t end_tip;
+        double root_distance;
+    };
+    std::vector<Entry> entries;  // In preorder.
+    std::vector<std::uint32_t> tip_entries;
+    std::vector<double> tip_root_distances;
+    std::vector<const Node*> tips;
+
+public:
+    explicit PatristicDistances(const Node& tree);
+
+    [[nodiscard]] std::size_t size() const {
+        return tips.size();
+    }
+    [[nodiscard]] const std::vector<const Node*>& get_tips() const {
+        return tips;
+    }
+    [[nodiscard]] const std::string& label(const std::size_t i) const {
+        return tips[i]->name;
+    }
+    /*
+     * Write row `i` of the matrix to `out`, which must have room for size() values.
+     */
+    template<typename T>
+    void row(std::size_t i, T* out) const;
+    /*
+     * Write rows [first, last) to `out`, splitting them across `threads` threads.
+     */
+    template<typename T>
+    void rows(std::size_t first, std::size_t last, T* out, unsigned threads = 1) const;
+    /*
+     * The full matrix, in row-major order.
+     */
+    template<typename T>
+    [[nodiscard]] std::vector<T> matrix(unsigned threads = 1) const;
+};
+
+/*
+ * Write the distance matrix in blocks of rows, so that memory is O(block size * n). The binary
+ * formats are the bare matrix in row-major order with native byte order; the tips are in
+ * preorder, which is the order of `newick leaves` if all tips are labelled.
+ */
+void write_distances(const PatristicDistances& distances, std::ostream& out, DistanceFormat format,
+                     unsigned threads = 1);
+
+#endif //NEWICK_DISTANCES_H
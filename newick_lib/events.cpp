@@ -0,0 +1,186 @@
+#include <charconv>
+#include <system_error>
+
+#include "events.h"
+
+
+static bool is_whitespace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0';
+}
+
+static bool is_special(const char c) {
+    return c == '(' || c == ')' || c == ',' || c == ':' || c == ';' || c == '[' || c == ']' || c == '\'';
+}
+
+/*
+ * The label and length of a node are collected until the next `,`, `)` or `;`. Whether the
+ * node is a leaf or an inner node is known from what came before: after `(` or `,` it's a
+ * leaf, after `)` an inner node.
+ */
+std::optional<ParseError> parse_events(const std::string_view characters, TreeHandler& handler) {
+    long depth { 0 };
+    bool closing { false };  // Whether the current node is an inner node, i.e. follows `)`.
+    bool in_length { false };
+    bool in_tree { false };
+    std::string_view label;
+    std::string_view length;
+    std::size_t i { 0 };
+    while (i < characters.size()) {
+        const char c { characters[i] };
+        if (is_whitespace(c)) {
+            i++;
+            continue;
+        }
+        switch (c) {
+            case '[': {
+                const std::size_t end { skip_quoted(characters, i) };
+                if (end == std::string_view::npos) {
+                    return ParseError {i, "unclosed comment"};
+                }
+                i = end;
+                continue;
+            }
+            case ']':
+                return ParseError {i, "unexpected ']'"};
+            case '(':
+                if (closing || in_length || !label.empty()) {
+                    return ParseError {i, "unexpected '('"};
+                }
+                in_tree = true;
+                depth++;
+                handler.on_open();
+                break;
+            case ',':
+            case ')':
+            case ';':
+                if (in_length && length.empty()) {
+                    return ParseError {i, "missing branch length"};
+                }
+                if (c == ';' ? depth > 0 : depth == 0) {
+                    return ParseError {i, c == ';' ? "unbalanced '('" : (c == ',' ? "',' outside of braces" : "unbalanced ')'")};
+                }
+                if (c != ';' || in_tree) {
+                    if (closing) {
+                        handler.on_close(label, length);
+                    } else {
+                        handler.on_leaf(label, length);
+                    }
+                }
+                label = length = std::string_view();
+                in_length = false;
+                closing = c == ')';
+                if (c == ')') {
+                    depth--;
+                } else if (c == ';') {
+                    if (in_tree) {
+                        handler.on_tree_end();
+                    }
+                    in_tree = false;
+                }
+                break;
+            case ':':
+                if (in_length) {
+                    return ParseError {i, "unexpected ':'"};
+                }
+                in_tree = true;
+                in_length = true;
+                break;
+            case '\'': {
+                if (in_length || !label.empty()) {
+                    return ParseError {i, "unexpected label"};
+                }
+                const std::size_t end { skip_quoted(characters, i) };
+                if (end == std::string_view::npos) {
+                    return ParseError {i, "unclosed quote"};
+                }
+                in_tree = true;
+                label = characters.substr(i, end - i);
+                i = end;
+                continue;
+            }
+            default: {
+                std::size_t end { i };
+                while (end < characters.size() && !is_special(characters[end])) {
+                    end++;
+                }
+                std::size_t last { end };
+                while (is_whitespace(characters[last - 1])) {
+                    last--;
+                }
+                std::string_view& target { in_length ? length : label };
+                if (!target.empty()) {
+                    return ParseError {i, in_length ? "invalid branch length" : "unexpected label"};
+                }
+                if (in_length) {  // Checked like validate() does, which may be run first.
+                    double value;
+                    const auto [p, error] { std::from_chars(characters.data() + i, characters.data() + last, value) };
+                    if (error != std::errc() || p != characters.data() + last) {
+                        return ParseError {i, "invalid branch length"};
+                    }
+                }
+                in_tree = true;
+                target = characters.substr(i, last - i);
+                i = end;
+                continue;
+            }
+        }
+        i++;
+    }
+    if (in_tree) {
+        return ParseError {characters.size(), "missing ';'"};
+    }
+    return std::nullopt;
+}
+
+
+NewickWriter::NewickWriter(std::ostream& out)
+    : out {out}
+{
+    buffer.reserve(1 << 16);
+}
+
+NewickWriter::~NewickWriter() {
+    flush();
+}
+
+void NewickWriter::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void NewickWriter::write_node(const std::string_view label, const std::string_view length) {
+    buffer.append(label);
+    if (!length.empty()) {
+        buffer.push_back(':');
+        buffer.append(length);
+    }
+    comma = true;
+    if (buffer.size() > (1 << 16) - 64) {
+        flush();
+    }
+}
+
+void NewickWriter::on_open() {
+    if (comma) {
+        buffer.push_back(',');
+    }
+    buffer.push_back('(');
+    comma = false;
+}
+
+void NewickWriter::on_leaf(const std::string_view label, const std::string_view length) {
+    if (comma) {
+        buffer.push_back(',');
+    }
+    write_node(label, length);
+}
+
+void NewickWriter::on_close(const std::string_view label, const std::string_view length) {
+    buffer.push_back(')');
+    write_node(label, length);
+}
+
+void NewickWriter::on_tree_end() {
+    buffer.append(";\n");
+    comma = false;
+}
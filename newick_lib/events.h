@@ -0,0 +1,64 @@
+#ifndef NEWICK_EVENTS_H
+#define NEWICK_EVENTS_H
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "parser.h"
+
+/*
+ * Receives the events of an event-driven parse, e.g. for `((a:1,b)c,d);`:
+ *
+ * on_open(), on_open(), on_leaf("a", "1"), on_leaf("b", ""), on_close("c", ""),
+ * on_leaf("d", ""), on_close("", ""), on_tree_end()
+ *
+ * Labels and lengths are spans of the input. Quoted labels keep their quotes, so that they
+ * can be written back as they are (use `unquote` to get the name).
+ */
+class TreeHandler {
+public:
+    virtual ~TreeHandler() = default;
+
+    // An inner node starts, i.e. a `(`.
+    virtual void on_open() {}
+    virtual void on_leaf(std::string_view, std::string_view) {}
+    // An inner node ends, i.e. a `)` followed by the node's label and length.
+    virtual void on_close(std::string_view, std::string_view) {}
+    virtual void on_tree_end() {}
+};
+
+/*
+ * Parse all trees in `characters`, calling the handler for each node, but building no nodes.
+ * Apart from what the handler does, this needs constant memory, so it works for trees too
+ * large to be built. Comments are skipped. Parsing stops at the first error, which is
+ * returned.
+ */
+std::optional<ParseError> parse_events(std::string_view characters, TreeHandler& handler);
+
+/*
+ * Writes the trees described by the events as Newick, one tree per line. Streaming transforms
+ * can derive from the writer and override the events they need to change.
+ */
+class NewickWriter : public TreeHandler {
+    std::ostream& out;
+    std::string buffer;
+    bool comma { false };  // Whether the next node needs a separating comma.
+
+    void write_node(std::string_view label, std::string_view length);
+
+public:
+    explicit NewickWriter(std::ostream& out);
+    ~NewickWriter() override;
+    NewickWriter(const NewickWriter&) = delete;
+    NewickWriter& operator=(const NewickWriter&) = delete;
+
+    void on_open() override;
+    void on_leaf(std::string_view label, std::string_view length) override;
+    void on_close(std::string_view label, std::string_view length) override;
+    void on_tree_end() override;
+    // Write all buffered output to the stream. Call before checking the stream.
+    virtual void flush();
+};
+
+#endif //NEWICK_EVENTS_H
@@ -0,0 +1,298 @@
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "generate.h"
+
+
+long FlatTree::add_node(const double length) {
+    nodes.push_back(FlatNode {-1, -1, -1, length});
+    return static_cast<long>(nodes.size()) - 1;
+}
+
+/*
+ * Append `child` to the children of `node`. Children are prepended to the linked list, so
+ * callers add them in reverse order.
+ */
+void FlatTree::add_child(const long node, const long child) {
+    nodes[child].parent = node;
+    nodes[child].next_sibling = nodes[node].first_child;
+    nodes[node].first_child = child;
+}
+
+std::string FlatTree::tip_label(const long tip) const {
+    switch (labels) {
+        case prefixed:
+            return prefix + std::to_string(tip + 1);
+        case numbered:
+            return std::to_string(tip + 1);
+        default:
+            return "";
+    }
+}
+
+static char* format_length(char* first, char* last, const double length) {
+    return std::to_chars(first, last, length, std::chars_format::general, 6).ptr;
+}
+
+std::unique_ptr<Node> FlatTree::to_node() const {
+    std::vector<std::unique_ptr<Node>> owners;
+    std::vector<Node*> pointers;
+    owners.reserve(nodes.size());
+    pointers.reserve(nodes.size());
+    char buffer[32];
+    for (unsigned long i = 0; i < nodes.size(); i++) {
+        std::string length;
+        if (has_lengths && static_cast<long>(i) != root) {
+            length.assign(buffer, format_length(buffer, buffer + sizeof buffer, nodes[i].branch_length));
+        }
+        owners.push_back(std::make_unique<Node>(i < tips ? tip_label(static_cast<long>(i)) : "", length));
+        pointers.push_back(owners.back().get());
+    }
+    for (unsigned long i = 0; i < nodes.size(); i++) {
+        for (long child = nodes[i].first_child; child != -1; child = nodes[child].next_sibling) {
+            pointers[i]->add_child(std::move(owners[child]));
+        }
+    }
+    return std::move(owners[root]);
+}
+
+/*
+ * Write the tree in Newick format. We walk the tree using the parent links, so no recursion
+ * (or stack) is needed, and buffer the output in large chunks.
+ */
+void FlatTree::write_newick(std::ostream& out) const {
+    std::string buffer;
+    buffer.reserve(1 << 16);
+    char number[32];
+    long node { root };
+    while (node != -1) {
+        // Descend to the leftmost tip.
+        while (nodes[node].first_child != -1) {
+            buffer.push_back('(');
+            node = nodes[node].first_child;
+        }
+        // Finish nodes bottom-up, until we find a sibling to continue with.
+        while (true) {
+            if (static_cast<unsigned long>(node) < tips && labels != unlabelled) {
+                if (labels == prefixed) {
+                    buffer.append(prefix);
+                }
+                buffer.append(number, std::to_chars(number, number + sizeof number, node + 1).ptr);
+            }
+            if (has_lengths && node != root) {
+                buffer.push_back(':');
+                buffer.append(number, format_length(number, number + sizeof number, nodes[node].branch_length));
+            }
+            if (buffer.size() > (1 << 16) - 64) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+            if (node == root) {
+                node = -1;
+                break;
+            }
+            if (nodes[node].next_sibling != -1) {
+                buffer.push_back(',');
+                node = nodes[node].next_sibling;
+                break;
+            }
+            buffer.push_back(')');
+            node = nodes[node].parent;
+        }
+    }
+    buffer.push_back(';');
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+
+TreeGenerator::TreeGenerator(GeneratorOptions options)
+    : options {std::move(options)}, state {0}
+{
+    if (this->options.tips == 0) {
+        throw std::invalid_argument("trees must have at least one tip");
+    }
+    state = this->options.seed;
+}
+
+/*
+ * SplitMix64: fast, and - unlike the std:: distributions - specified exactly, so that seeds
+ * are reproducible across standard libraries.
+ */
+std::uint64_t TreeGenerator::next_random() {
+    std::uint64_t z { state += 0x9e3779b97f4a7c15 };
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Random integer in [0, n).
+ */
+unsigned long TreeGenerator::random_index(const unsigned long n) {
+    return static_cast<unsigned long>((static_cast<unsigned __int128>(next_random()) * n) >> 64);
+}
+
+/*
+ * Random double in [0, 1).
+ */
+double TreeGenerator::random_unit() {
+    return static_cast<double>(next_random() >> 11) * 0x1.0p-53;
+}
+
+double TreeGenerator::random_length() {
+    switch (options.lengths) {
+        case exponential_lengths:
+            return -std::log1p(-random_unit()) / options.rate;
+        case uniform_lengths:
+            return random_unit() * 2.0 / options.rate;
+        default:
+            return 1.0;
+    }
+}
+
+/*
+ * Merge random pairs of lineages, going backwards in time. Yule and Kingman coalescent
+ * trees have the same topology distribution, but differ in the waiting times: With k
+ * lineages these are exponentially distributed with rate k*rate (Yule) or
+ * k*(k-1)/2*rate (coalescent).
+ */
+void TreeGenerator::coalesce(FlatTree& tree, const bool yule_times) {
+    std::vector<long> lineages(options.tips);
+    std::vector<double> heights(options.tips, 0.0);
+    for (unsigned long i = 0; i < options.tips; i++) {
+        lineages[i] = tree.add_node();
+    }
+    double height { 0.0 };
+    for (unsigned long k = options.tips; k > 1; k--) {
+        const double rate { (yule_times ? static_cast<double>(k) : static_cast<double>(k * (k - 1)) / 2) * options.rate };
+        height += -std::log1p(-random_unit()) / rate;
+
+        const unsigned long i { random_index(k) };
+        unsigned long j { random_index(k - 1) };
+        if (j >= i) {
+            j++;
+        }
+        const long node { tree.add_node() };
+        heights.push_back(height);
+        tree.add_child(node, lineages[j]);
+        tree.add_child(node, lineages[i]);
+        lineages[i] = node;
+        lineages[j] = lineages[k - 1];
+    }
+    tree.root = lineages[0];
+    for (unsigned long i = 0; i < tree.nodes.size(); i++) {
+        if (static_cast<long>(i) != tree.root) {
+            tree.nodes[i].branch_length = options.lengths == model_lengths
+                ? heights[tree.nodes[i].parent] - heights[i]
+                : random_length();
+        }
+    }
+}
+
+/*
+ * Rémy's algorithm: Insert each new tip on a uniformly chosen edge (including the one above
+ * the root), attaching it randomly to the left or right.
+ */
+void TreeGenerator::remy(FlatTree& tree) {
+    for (unsigned long i = 0; i < options.tips; i++) {
+        tree.add_node(random_length());
+    }
+    tree.root = 0;
+    std::vector<long> nodes {0};  // Nodes inserted so far, i.e. candidate edges.
+    nodes.reserve(2 * options.tips);
+    for (unsigned long tip = 1; tip < options.tips; tip++) {
+        const long target { nodes[random_index(nodes.size())] };
+        const long node { tree.add_node(random_length()) };
+        // Put `node` in place of `target`.
+        const long parent { tree.nodes[target].parent };
+        tree.nodes[node].parent = parent;
+        tree.nodes[node].next_sibling = tree.nodes[target].next_sibling;
+        if (parent == -1) {
+            tree.root = node;
+        } else if (tree.nodes[parent].first_child == target) {
+            tree.nodes[parent].first_child = node;
+        } else {
+            tree.nodes[tree.nodes[parent].first_child].next_sibling = node;
+        }
+        tree.nodes[target].next_sibling = -1;
+        if (random_index(2) == 0) {
+            tree.add_child(node, target);
+            tree.add_child(node, static_cast<long>(tip));
+        } else {
+            tree.add_child(node, static_cast<long>(tip));
+            tree.add_child(node, target);
+        }
+        nodes.push_back(static_cast<long>(tip));
+        nodes.push_back(node);
+    }
+}
+
+FlatTree TreeGenerator::generate() {
+    FlatTree tree;
+    tree.tips = options.tips;
+    tree.has_lengths = options.lengths != no_lengths;
+    tree.labels = options.labels;
+    tree.prefix = options.prefix;
+    tree.nodes.reserve(2 * options.tips);
+
+    switch (options.model) {
+        case yule:
+            coalesce(tree, true);
+            break;
+        case coalescent:
+            coalesce(tree, false);
+            break;
+        case uniform:
+            remy(tree);
+            break;
+        case caterpillar: {  // ((((t1,t2),t3),t4),t5)
+            for (unsigned long i = 0; i < options.tips; i++) {
+                tree.add_node(random_length());
+            }
+            long node { 0 };
+            for (unsigned long tip = 1; tip < options.tips; tip++) {
+                const long internal { tree.add_node(random_length()) };
+                tree.add_child(internal, static_cast<long>(tip));
+                tree.add_child(internal, node);
+                node = internal;
+            }
+            tree.root = node;
+            break;
+        }
+        case balanced: {
+            // Join neighbouring subtrees level by level.
+            std::vector<long> level;
+            for (unsigned long i = 0; i < options.tips; i++) {
+                level.push_back(tree.add_node(random_length()));
+            }
+            while (level.size() > 1) {
+                std::vector<long> next;
+                for (unsigned long i = 0; i + 1 < level.size(); i += 2) {
+                    const long internal { tree.add_node(random_length()) };
+                    tree.add_child(internal, level[i + 1]);
+                    tree.add_child(internal, level[i]);
+                    next.push_back(internal);
+                }
+                if (level.size() % 2 == 1) {
+                    next.push_back(level.back());
+                }
+                level = std::move(next);
+            }
+            tree.root = level.empty() ? -1 : level[0];
+            break;
+        }
+        case star: {
+            for (unsigned long i = 0; i < options.tips; i++) {
+                tree.add_node(random_length());
+            }
+            tree.root = tree.add_node();
+            for (unsigned long tip = options.tips; tip > 0; tip--) {
+                tree.add_child(tree.root, static_cast<long>(tip - 1));
+            }
+            break;
+        }
+    }
+    return tree;
+}
@@ -0,0 +1,94 @@
+#ifndef NEWICK_GENERATE_H
+#define NEWICK_GENERATE_H
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "node.h"
+
+enum TreeModel {
+    yule,  // Pure birth process.
+    coalescent,  // Kingman coalescent.
+    uniform,  // Uniform distribution over rooted binary topologies (Rémy's algorithm).
+    caterpillar,
+    balanced,
+    star,
+};
+
+enum BranchLengths {
+    no_lengths,
+    model_lengths,  // Waiting times for yule and coalescent, 1.0 for the other models.
+    exponential_lengths,  // Exponentially distributed with the given rate.
+    uniform_lengths,  // Uniformly distributed in [0, 2/rate), i.e. with mean 1/rate.
+};
+
+enum LabelScheme {
+    prefixed,  // t1, t2, ...
+    numbered,  // 1, 2, ... as used in NEXUS translate tables.
+    unlabelled,
+};
+
+struct GeneratorOptions {
+    TreeModel model { yule };
+    unsigned long tips { 10 };
+    std::uint64_t seed { 1 };
+    BranchLengths lengths { model_lengths };
+    double rate { 1.0 };
+    LabelScheme labels { prefixed };
+    std::string prefix { "t" };
+};
+
+/*
+ * A node of a FlatTree. Children are linked via `first_child` and `next_sibling`, missing
+ * links are -1. Keeping all fields of a node together means walking a randomly ordered
+ * tree costs one cache miss per node.
+ */
+struct FlatNode {
+    long parent { -1 };
+    long first_child { -1 };
+    long next_sibling { -1 };
+    double branch_length { 0.0 };
+};
+
+/*
+ * A tree in flat, index based form. Nodes 0..tips-1 are the tips.
+ */
+class FlatTree {
+public:
+    unsigned long tips { 0 };
+    long root { -1 };
+    std::vector<FlatNode> nodes;
+    bool has_lengths { false };
+    LabelScheme labels { prefixed };
+    std::string prefix;
+
+    long add_node(double length = 0.0);
+    void add_child(long node, long child);
+    [[nodiscard]] std::string tip_label(long tip) const;
+    [[nodiscard]] std::unique_ptr<Node> to_node() const;
+    void write_newick(std::ostream& out) const;
+};
+
+/*
+ * Generates random trees. The output is fully determined by the options, in particular the
+ * same seed yields the same sequence of trees on all platforms.
+ */
+class TreeGenerator {
+    GeneratorOptions options;
+    std::uint64_t state;
+
+    std::uint64_t next_random();
+    unsigned long random_index(unsigned long n);
+    double random_unit();
+    double random_length();
+    void coalesce(FlatTree& tree, bool yule_times);
+    void remy(FlatTree& tree);
+
+public:
+    explicit TreeGenerator(GeneratorOptions options);
+    FlatTree generate();
+};
+
+#endif //NEWICK_GENERATE_H
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "index.h"
+#include "nexus.h"
+#include "parser.h"
+
+
+static constexpr std::uint64_t INDEX_VERSION { 2 };
+
+TreeIndex::TreeIndex(const std::string_view data, const std::uint64_t time)
+    : data_size { data.size() }, data_time { time }
+{
+    // Index the trees the readers return, so that both agree on the trees of any file.
+    const std::unique_ptr<TreeReader> reader {make_reader(data)};
+    while (const auto newick {reader->next_newick()}) {
+        trees.push_back(TreeOffset {reader->offset(*newick), newick->size()});
+    }
+}
+
+void TreeIndex::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    const std::uint64_t header[4] {INDEX_VERSION, data_size, data_time, trees.size()};
+    out.write("NWKI", 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof header);
+    out.write(reinterpret_cast<const char*>(trees.data()), static_cast<std::streamsize>(trees.size() * sizeof(TreeOffset)));
+    if (!out) {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+TreeIndex TreeIndex::load(const std::string& filename) {
+    const MappedFile file {filename};
+    const std::string_view data {file.view()};
+    std::uint64_t header[4];
+    if (data.size() < 4 + sizeof header || !data.starts_with("NWKI")) {
+        throw std::runtime_error(filename + " is not an index file");
+    }
+    std::memcpy(header, data.data() + 4, sizeof header);
+    const auto [version, size, time, n] {header};
+    // Compare the count by division, as the multiplication may overflow.
+    if (version != INDEX_VERSION || n != (data.size() - 4 - sizeof header) / sizeof(TreeOffset)) {
+        throw std::runtime_error(filename + ": corrupt index file");
+    }
+    TreeIndex index;
+    index.data_size = size;
+    index.data_time = time;
+    index.trees.resize(n);
+    std::memcpy(index.trees.data(), data.data() + 4 + sizeof header, n * sizeof(TreeOffset));
+    for (const TreeOffset& tree : index.trees) {  // Trees must lie within the indexed file.
+        if (tree.offset > size || tree.length > size - tree.offset) {
+            throw std::runtime_error(filename + ": corrupt index file");
+        }
+    }
+    return index;
+}
+
+std::string index_filename(const std::string& filename) {
+    return filename + ".idx";
+}
+
+std::uint64_t modification_time(const std::string& filename) {
+    return static_cast<std::uint64_t>(std::filesystem::last_write_time(filename).time_since_epoch().count());
+}
+
+
+IndexedTreeFile::IndexedTreeFile(const std::string& filename)
+    : file {filename}
+{
+    const std::uint64_t time {modification_time(filename)};
+    try {
+        index = TreeIndex::load(index_filename(filename));
+    } catch (const std::runtime_error&) {  // No usable sidecar file.
+    }
+    // Rewriting a file with different trees of the same total size changes its time.
+    if (index.indexed_size() != file.view().size() || index.indexed_time() != time) {  // Missing or stale.
+        index = TreeIndex(file.view(), time);
+    }
+}
+
+std::string_view IndexedTreeFile::newick(const std::size_t i) const {
+    return file.view().substr(index[i].offset, index[i].length);
+}
+
+std::unique_ptr<Node> IndexedTreeFile::tree(const std::size_t i) const {
+    return parse(newick(i));
+}
+
+std::vector<std::unique_ptr<Node>> IndexedTreeFile::trees(
+        const std::size_t first, const std::size_t last, const std::size_t stride) const {
+    std::vector<std::unique_ptr<Node>> result;
+    for (std::size_t i = first; i < std::min(last, size()); i += std::max<std::size_t>(stride, 1)) {
+        result.push_back(tree(i));
+    }
+    return result;
+}
@@ -0,0 +1,83 @@
+#ifndef NEWICK_INDEX_H
+#define NEWICK_INDEX_H
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "node.h"
+#include "util.h"
+
+struct TreeOffset {
+    std::uint64_t offset;
+    std::uint64_t length;  // Including the terminating `;`, if any.
+};
+
+/*
+ * Byte offsets of the `;`-terminated trees in a multi-tree file, or of the Newick strings of
+ * the TREE statements in a NEXUS file. The trees are those returned by make_reader(), which
+ * includes trailing input without `;` as a last tree.
+ *
+ * Indexes are stored in a sidecar file (FILE.idx) holding the magic bytes "NWKI", a version,
+ * the size and modification time of the indexed file - to detect stale indexes - the number
+ * of trees and the (offset, length) pairs, all as native uint64.
+ */
+class TreeIndex {
+    std::uint64_t data_size { 0 };
+    std::uint64_t data_time { 0 };
+    std::vector<TreeOffset> trees;
+
+public:
+    TreeIndex() = default;
+    // `time` is the modification_time() of the file holding `data`, if any.
+    explicit TreeIndex(std::string_view data, std::uint64_t time = 0);
+
+    [[nodiscard]] std::size_t size() const {
+        return trees.size();
+    }
+    [[nodiscard]] const TreeOffset& operator[](const std::size_t i) const {
+        return trees[i];
+    }
+    [[nodiscard]] std::uint64_t indexed_size() const {
+        return data_size;
+    }
+    [[nodiscard]] std::uint64_t indexed_time() const {
+        return data_time;
+    }
+
+    void save(const std::string& filename) const;
+    [[nodiscard]] static TreeIndex load(const std::string& filename);
+};
+
+[[nodiscard]] std::string index_filename(const std::string& filename);
+
+/*
+ * The last modification time of a file, in the units of the filesystem clock.
+ */
+[[nodiscard]] std::uint64_t modification_time(const std::string& filename);
+
+/*
+ * A memory-mapped multi-tree file, giving random access to its trees. The index is read from
+ * the sidecar file if it exists and matches, and computed otherwise.
+ */
+class IndexedTreeFile {
+    MappedFile file;
+    TreeIndex index;
+
+public:
+    explicit IndexedTreeFile(const std::string& filename);
+
+    [[nodiscard]] std::size_t size() const {
+        return index.size();
+    }
+    [[nodiscard]] std::string_view data() const {
+        return file.view();
+    }
+    [[nodiscard]] std::string_view newick(std::size_t i) const;
+    [[nodiscard]] std::unique_ptr<Node> tree(std::size_t i) const;
+    // Trees first, first + stride, ... up to (excluding) last.
+    [[nodiscard]] std::vector<std::unique_ptr<Node>> trees(std::size_t first, std::size_t last, std::size_t stride = 1) const;
+};
+
+#endif //NEWICK_INDEX_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "lca.h"
+
+
+/*
+ * Initial slot for a node in a table of size `size` (a power of two), by Fibonacci hashing
+ * of the address.
+ */
+static std::size_t slot_of(const Node* node, const std::size_t size) {
+    const auto address {reinterpret_cast<std::uintptr_t>(node)};
+    return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ULL) >> (64 - std::countr_zero(size))) & (size - 1);
+}
+
+LcaIndex::LcaIndex(const Node& tree)
+    : tree {tree}, modifications {tree.get_modifications()}
+{
+    std::vector<std::pair<const Node*, std::uint32_t>> stack {{&tree, 0}};  // Nodes and their parents.
+    while (!stack.empty()) {  // Preorder, as in Node::traverse.
+        const auto [node, parent] {stack.back()};
+        stack.pop_back();
+        const auto index {static_cast<std::uint32_t>(nodes.size())};
+        nodes.push_back(node);
+        parents.push_back(parent);
+        depths.push_back(index == 0 ? 0 : depths[parent] + 1);
+        const auto& children {node->get_children()};
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.emplace_back(child->get(), index);
+        }
+    }
+    ids.resize(std::bit_ceil(2 * nodes.size()));
+    for (std::uint32_t i = 0; i < nodes.size(); i++) {
+        std::size_t slot {slot_of(nodes[i], ids.size())};
+        while (ids[slot].node != nullptr) {
+            slot = (slot + 1) & (ids.size() - 1);
+        }
+        ids[slot] = Slot {nodes[i], i};
+    }
+
+    const std::size_t n {nodes.size()};
+    table.emplace_back(n);
+    for (std::uint32_t i = 0; i < n; i++) {
+        table[0][i] = i;
+    }
+    for (std::size_t k = 1; (std::size_t {1} << k) <= n; k++) {
+        const std::size_t half {std::size_t {1} << (k - 1)};
+        const auto& previous {table[k - 1]};
+        std::vector<std::uint32_t> level(n - (half << 1) + 1);
+        for (std::size_t i = 0; i < level.size(); i++) {
+            const std::uint32_t a {previous[i]};
+            const std::uint32_t b {previous[i + half]};
+            level[i] = depths[b] < depths[a] ? b : a;
+        }
+        table.push_back(std::move(level));
+    }
+}
+
+void LcaIndex::check_modifications() const {
+    if (tree.get_modifications() != modifications) {
+        throw std::logic_error("LcaIndex is stale, the tree was modified");
+    }
+}
+
+std::uint32_t LcaIndex::id(const Node* node) const {
+    for (std::size_t slot = slot_of(node, ids.size()); ; slot = (slot + 1) & (ids.size() - 1)) {
+        if (ids[slot].node == node) {
+            return ids[slot].id;
+        }
+        if (ids[slot].node == nullptr) {
+            throw std::invalid_argument("node is not in the indexed tree");
+        }
+    }
+}
+
+/*
+ * The shallowest node in the preorder range [first, last], from two overlapping ranges of
+ * length 2^k.
+ */
+std::uint32_t LcaIndex::shallowest(const std::uint32_t first, const std::uint32_t last) const {
+    const auto k {static_cast<std::size_t>(std::bit_width(last - first + 1) - 1)};
+    const std::uint32_t a {table[k][first]};
+    const std::uint32_t b {table[k][last + 1 - (std::uint32_t {1} << k)]};
+    return depths[b] < depths[a] ? b : a;
+}
+
+std::uint32_t LcaIndex::lca(std::uint32_t u, std::uint32_t v) const {
+    if (u == v) {
+        return u;
+    }
+    if (u > v) {
+        std::swap(u, v);
+    }
+    return parents[shallowest(u + 1, v)];
+}
+
+const Node* LcaIndex::mrca(const Node* a, const Node* b) const {
+    check_modifications();
+    return nodes[lca(id(a), id(b))];
+}
+
+const Node* LcaIndex::mrca(const std::vector<const Node*>& set) const {
+    check_modifications();
+    if (set.empty()) {
+        throw std::invalid_argument("the MRCA of an empty set is undefined");
+    }
+    std::uint32_t first {id(set[0])};
+    std::uint32_t last {first};
+    for (const Node* node : set) {
+        const std::uint32_t i {id(node)};
+        first = std::min(first, i);
+        last = std::max(last, i);
+    }
+    return nodes[lca(first, last)];
+}
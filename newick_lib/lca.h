@@ -0,0 +1,52 @@
+#ifndef NEWICK_LCA_H
+#define NEWICK_LCA_H
+#include <cstdint>
+#include <vector>
+
+#include "node.h"
+
+/*
+ * Index for O(1) lowest common ancestor (aka most recent common ancestor) queries, built in
+ * O(n log n) time and space.
+ *
+ * Instead of the classic Euler tour, we use a range minimum query over the preorder: for
+ * nodes u != v with u before v in preorder, the LCA is the parent of the shallowest node in
+ * the preorder range (u, v]. This needs a sparse table over n rather than 2n - 1 entries.
+ *
+ * Like NodeIndex, the index holds pointers to the nodes, so it must be rebuilt when nodes are
+ * added or removed. Removals are detected by `mrca`, which throws std::logic_error then.
+ */
+class LcaIndex {
+    const Node& tree;
+    unsigned long modifications { 0 };  // Of the tree, when the index was built.
+    std::vector<const Node*> nodes;  // In preorder.
+    std::vector<std::uint32_t> depths;
+    std::vector<std::uint32_t> parents;  // Preorder index of the parent; 0 for the root.
+    // Preorder indices of the nodes, in an open addressing table keyed by node address.
+    struct Slot {
+        const Node* node { nullptr };
+        std::uint32_t id { 0 };
+    };
+    std::vector<Slot> ids;
+    // table[k][i] is the shallowest node in the preorder range [i, i + 2^k).
+    std::vector<std::vector<std::uint32_t>> table;
+
+    void check_modifications() const;
+    [[nodiscard]] std::uint32_t id(const Node* node) const;
+    [[nodiscard]] std::uint32_t shallowest(std::uint32_t first, std::uint32_t last) const;
+    [[nodiscard]] std::uint32_t lca(std::uint32_t u, std::uint32_t v) const;
+
+public:
+    explicit LcaIndex(const Node& tree);
+
+    /*
+     * The MRCA of two nodes, in O(1). Throws std::invalid_argument for nodes not in the tree.
+     */
+    [[nodiscard]] const Node* mrca(const Node* a, const Node* b) const;
+    /*
+     * The MRCA of a set of nodes, in O(k): the MRCA of the first and last of them in preorder.
+     */
+    [[nodiscard]] const Node* mrca(const std::vector<const Node*>& set) const;
+};
+
+#endif //NEWICK_LCA_H
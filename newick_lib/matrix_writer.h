@@ -0,0 +1,95 @@
+#ifndef NEWICK_MATRIX_WRITER_H
+#define NEWICK_MATRIX_WRITER_H
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class DistanceFormat { phylip, float32, float64 };
+
+/*
+ * Writers for square matrices, shared by the distance commands. `Matrix` provides `size()`,
+ * `label(i)` and `rows<T>(first, last, out, threads)` for float and double.
+ */
+
+template<typename T, typename Matrix>
+void write_matrix_binary(const Matrix& matrix, std::ostream& out, const unsigned threads) {
+    const std::size_t n {matrix.size()};
+    const std::size_t block {std::max<std::size_t>(1, (std::size_t {1} << 24) / sizeof(T) / std::max<std::size_t>(n, 1))};
+    std::vector<T> buffer(std::min(block, n) * n);
+    for (std::size_t first = 0; first < n; first += block) {
+        const std::size_t last {std::min(first + block, n)};
+        matrix.template rows<T>(first, last, buffer.data(), threads);
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>((last - first) * n * sizeof(T)));
+        if (!out) {
+            throw std::runtime_error("error writing the matrix");
+        }
+    }
+}
+
+/*
+ * Square PHYLIP matrix, with the (relaxed) labels separated from the distances by a space.
+ * Relaxed PHYLIP has no quoting, so throws std::invalid_argument - before writing anything -
+ * for empty labels or labels containing whitespace.
+ */
+template<typename Matrix>
+void write_matrix_phylip(const Matrix& matrix, std::ostream& out, const unsigned threads) {
+    const std::size_t n {matrix.size()};
+    for (std::size_t i = 0; i < n; i++) {
+        const auto& label {matrix.label(i)};  // A string or a reference to one.
+        if (label.empty()) {
+            throw std::invalid_argument("cannot write unlabelled item " + std::to_string(i + 1) + " to PHYLIP");
+        }
+        if (label.find_first_of(" \t\n\r") != std::string::npos) {
+            throw std::invalid_argument("cannot write label with whitespace to PHYLIP: " + std::string(label));
+        }
+    }
+    const std::size_t block {std::max<std::size_t>(1, (std::size_t {1} << 21) / std::max<std::size_t>(n, 1))};
+    std::vector<double> buffer(std::min(block, n) * n);
+    std::string text;
+    char number[32];
+    out << n << "\n";
+    for (std::size_t first = 0; first < n; first += block) {
+        const std::size_t last {std::min(first + block, n)};
+        matrix.template rows<double>(first, last, buffer.data(), threads);
+        for (std::size_t i = first; i < last; i++) {
+            text.clear();
+            text.append(matrix.label(i));
+            for (std::size_t j = 0; j < n; j++) {
+                text.push_back(' ');
+                text.append(number, std::to_chars(number, number + sizeof number, buffer[(i - first) * n + j],
+                                                  std::chars_format::general, 6).ptr);
+            }
+            text.push_back('\n');
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+        if (!out) {
+            throw std::runtime_error("error writing the matrix");
+        }
+    }
+}
+
+/*
+ * Write the matrix in blocks of rows, so that memory is O(block size * n). The binary formats
+ * are the bare matrix in row-major order with native byte order. Throws std::runtime_error
+ * as soon as writing a block fails.
+ */
+template<typename Matrix>
+void write_matrix(const Matrix& matrix, std::ostream& out, const DistanceFormat format, const unsigned threads) {
+    switch (format) {
+        case DistanceFormat::float32:
+            write_matrix_binary<float>(matrix, out, threads);
+            break;
+        case DistanceFormat::float64:
+            write_matrix_binary<double>(matrix, out, threads);
+            break;
+        case DistanceFormat::phylip:
+            write_matrix_phylip(matrix, out, threads);
+            break;
+    }
+}
+
+#endif //NEWICK_MATRIX_WRITER_H
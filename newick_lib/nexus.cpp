@@ -0,0 +1,221 @@
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "nexus.h"
+#include "parser.h"
+
+
+static bool iequals(const std::string_view a, const std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_space(const char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+/*
+ * Split off the first whitespace separated word of a statement.
+ */
+static std::string_view first_word(const std::string_view statement) {
+    std::size_t end { 0 };
+    while (end < statement.size() && !is_space(statement[end]) && statement[end] != ';') {
+        end++;
+    }
+    return statement.substr(0, end);
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && is_space(s.front())) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && is_space(s.back())) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+bool is_nexus(const std::string_view input) {
+    return iequals(first_word(trim(input)), "#nexus");
+}
+
+std::unique_ptr<TreeReader> make_reader(const std::string_view input) {
+    if (is_nexus(input)) {
+        return std::make_unique<NexusReader>(input);
+    }
+    return std::make_unique<TreeReader>(input);
+}
+
+
+NexusReader::NexusReader(const std::string_view input)
+    : TreeReader {input}
+{
+    position = skip_whitespace_and_comments(0);
+    if (iequals(first_word(input.substr(position)), "#nexus")) {
+        position += 6;
+    }
+    // Skip statements up to BEGIN TREES.
+    bool in_trees { false };
+    while (!in_trees) {
+        const std::size_t start { skip_whitespace_and_comments(position) };
+        const std::size_t end { find_tree_end(input, start) };
+        if (end == std::string_view::npos) {
+            position = input.size();  // No TREES block.
+            return;
+        }
+        const std::string_view statement { input.substr(start, end - start) };
+        const std::string_view keyword { first_word(statement) };
+        in_trees = iequals(keyword, "begin") && iequals(first_word(trim(statement.substr(keyword.size()))), "trees");
+        position = end;
+    }
+    // Read the TRANSLATE table, if there is one, stopping at the first tree.
+    while (true) {
+        const std::size_t start { skip_whitespace_and_comments(position) };
+        const std::size_t end { find_tree_end(input, start) };
+        if (end == std::string_view::npos) {
+            return;
+        }
+        const std::string_view statement { input.substr(start, end - start - 1) };
+        const std::string_view keyword { first_word(statement) };
+        if (iequals(keyword, "translate")) {
+            parse_translate(statement.substr(keyword.size()));
+        } else if (iequals(keyword, "tree") || iequals(keyword, "utree") || iequals(keyword, "end") || iequals(keyword, "endblock")) {
+            return;
+        }
+        position = end;
+    }
+}
+
+std::size_t NexusReader::skip_whitespace_and_comments(std::size_t start) const {
+    while (start < input.size()) {
+        if (is_space(input[start])) {
+            start++;
+        } else if (input[start] == '[') {
+            const std::size_t end { input.find(']', start) };
+            start = end == std::string_view::npos ? input.size() : end + 1;
+        } else {
+            break;
+        }
+    }
+    return start;
+}
+
+/*
+ * Parse the comma separated `id label` pairs of a TRANSLATE table. Ids index `taxa`, so they
+ * may not exceed the number of entries, which keeps the table small for any input.
+ */
+void NexusReader::parse_translate(const std::string_view table) {
+    std::vector<std::pair<std::size_t, std::string_view>> entries;
+    std::size_t i { 0 };
+    while (i < table.size()) {
+        while (i < table.size() && (is_space(table[i]) || table[i] == ',')) {
+            i++;
+        }
+        if (i == table.size()) {
+            break;
+        }
+        std::size_t end { i };
+        while (end < table.size() && !is_space(table[end])) {
+            end++;
+        }
+        long id { -1 };
+        const auto [p, error] { std::from_chars(table.data() + i, table.data() + end, id) };
+        if (error != std::errc() || p != table.data() + end || id < 0) {
+            throw std::runtime_error("TRANSLATE keys must be non-negative integers: " + std::string(table.substr(i, end - i)));
+        }
+        i = end;
+        while (i < table.size() && is_space(table[i])) {
+            i++;
+        }
+        // The label runs up to the next comma which is not part of a quoted label.
+        end = i;
+        while (end < table.size() && table[end] != ',') {
+            if (table[end] == '\'') {
+                end = table.find('\'', end + 1);
+                while (end != std::string_view::npos && end + 1 < table.size() && table[end + 1] == '\'') {
+                    end = table.find('\'', end + 2);
+                }
+                if (end == std::string_view::npos) {
+                    throw std::runtime_error("unterminated quoted label in TRANSLATE table");
+                }
+            }
+            end++;
+        }
+        entries.emplace_back(static_cast<std::size_t>(id), trim(table.substr(i, end - i)));
+        i = end;
+    }
+    for (const auto& [id, label] : entries) {
+        if (id > entries.size()) {
+            throw std::runtime_error("TRANSLATE key larger than the number of entries: " + std::to_string(id));
+        }
+        if (id >= taxa.size()) {
+            taxa.resize(id + 1);
+        }
+        taxa[id] = unquote(label);
+    }
+}
+
+std::optional<std::string_view> NexusReader::next_newick() {
+    while (true) {
+        const std::size_t start { skip_whitespace_and_comments(position) };
+        const std::size_t end { find_tree_end(input, start) };
+        if (end == std::string_view::npos) {
+            position = input.size();
+            return std::nullopt;
+        }
+        const std::string_view statement { input.substr(start, end - start) };
+        const std::string_view keyword { first_word(statement) };
+        if (iequals(keyword, "end") || iequals(keyword, "endblock")) {
+            position = input.size();
+            return std::nullopt;
+        }
+        position = end;
+        if (iequals(keyword, "tree") || iequals(keyword, "utree")) {
+            // Find the `=` after the tree name, which may be followed by a comment like [&lnP=-12.5].
+            std::size_t equals { 0 };
+            while (equals < statement.size() && statement[equals] != '=') {
+                equals = statement[equals] == '[' ? statement.find(']', equals) : equals + 1;
+            }
+            if (equals >= statement.size()) {
+                throw std::runtime_error("invalid TREE statement: " + std::string(statement));
+            }
+            // Skip comments like [&R] or [&lnP=-123.4] in front of the tree.
+            const std::size_t tree_start { skip_whitespace_and_comments(start + equals + 1) };
+            return input.substr(tree_start, end - tree_start);
+        }
+    }
+}
+
+long NexusReader::taxon_id(const std::string_view label) const {
+    long id { -1 };
+    const auto [p, error] { std::from_chars(label.data(), label.data() + label.size(), id) };
+    if (error != std::errc() || p != label.data() + label.size() || id < 0
+            || static_cast<std::size_t>(id) >= taxa.size() || taxa[static_cast<std::size_t>(id)].empty()) {
+        return -1;
+    }
+    return id;
+}
+
+std::string_view NexusReader::taxon(const std::string_view label) const {
+    const long id { taxon_id(label) };
+    return id < 0 ? label : std::string_view(taxa[static_cast<std::size_t>(id)]);
+}
+
+void NexusReader::translate(Node& tree) const {
+    for (Node* node : tree.traverse()) {
+        const long id { taxon_id(node->name) };
+        if (id >= 0) {
+            node->name = taxa[static_cast<std::size_t>(id)];
+        }
+    }
+}
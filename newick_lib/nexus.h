@@ -0,0 +1,65 @@
+#ifndef NEWICK_NEXUS_H
+#define NEWICK_NEXUS_H
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "node.h"
+#include "reader.h"
+
+/*
+ * Reads the trees from the TREES block of a NEXUS file, as written by MrBayes or BEAST:
+ *
+ * #NEXUS
+ * BEGIN TREES;
+ *     TRANSLATE
+ *         1 Homo_sapiens,
+ *         2 'Pan troglodytes';
+ *     TREE STATE_0 = [&R] (1:0.1,2:0.2);
+ * END;
+ *
+ * Trees are returned as they are, i.e. nodes are labelled with the integer ids of the
+ * TRANSLATE table, which fit into the small string buffer of a label and thus need no
+ * allocation. Ids are resolved to taxon names on demand.
+ */
+class NexusReader : public TreeReader {
+    std::vector<std::string> taxa;  // Taxon names, indexed by id.
+
+    std::size_t skip_whitespace_and_comments(std::size_t start) const;
+    void parse_translate(std::string_view table);
+
+public:
+    explicit NexusReader(std::string_view input);
+
+    std::optional<std::string_view> next_newick() override;
+
+    [[nodiscard]] const std::vector<std::string>& get_taxa() const {
+        return taxa;
+    }
+    /*
+     * The id of a translated label, or -1 if the label isn't in the TRANSLATE table.
+     */
+    [[nodiscard]] long taxon_id(std::string_view label) const;
+    /*
+     * The taxon name for a label, or the label itself if it isn't in the TRANSLATE table.
+     */
+    [[nodiscard]] std::string_view taxon(std::string_view label) const;
+    /*
+     * Replace all translated labels in the tree with taxon names.
+     */
+    void translate(Node& tree) const;
+};
+
+/*
+ * Check whether the input starts with the #NEXUS header.
+ */
+[[nodiscard]] bool is_nexus(std::string_view input);
+
+/*
+ * A reader for NEXUS or Newick input.
+ */
+[[nodiscard]] std::unique_ptr<TreeReader> make_reader(std::string_view input);
+
+#endif //NEWICK_NEXUS_H
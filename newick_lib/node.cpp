@@ -1,8 +1,6 @@
 #include <algorithm>
 #include <iterator>
 #include <regex>
-#include <set>
-#include <stack>
 #include <utility>
 
 #include "node.h"
@@ -14,6 +12,51 @@ Node::Node(std::string name, std::string branch_length)
     : name{std::move(name)}, branch_length{std::move(branch_length)} {
 }
 
+Node::Node(Node&& other) noexcept
+    : children {std::move(other.children)}, modifications {other.modifications},
+      name {std::move(other.name)}, branch_length {std::move(other.branch_length)}
+{
+    for (const auto& child : children) {
+        child->parent = this;
+    }
+    other.mark_modified();  // Lost its descendants.
+}
+
+Node& Node::operator=(Node&& other) noexcept {
+    children = std::move(other.children);
+    // Different from the count of both nodes before, as the descendants of this node are gone.
+    modifications = std::max(modifications, other.modifications);
+    mark_modified();
+    other.mark_modified();
+    name = std::move(other.name);
+    branch_length = std::move(other.branch_length);
+    for (const auto& child : children) {
+        child->parent = this;
+    }
+    return *this;
+}
+
+/*
+ * Destroy descendants iteratively. The default destructor would recurse, and overflow the
+ * stack for deep trees.
+ */
+Node::~Node() {
+    std::vector<std::unique_ptr<Node>> nodes { std::move(children) };
+    while (!nodes.empty()) {
+        std::unique_ptr<Node> node { std::move(nodes.back()) };
+        nodes.pop_back();
+        if (node) {  // Skip moved-from children.
+            std::ranges::move(node->children, std::back_inserter(nodes));
+            node->children.clear();
+        }
+    }
+}
+
+void Node::mark_modified() noexcept {
+    for (Node* node = this; node != nullptr; node = node->parent) {
+        node->modifications++;
+    }
+}
 
 double Node::branch_length_as_float() const {
     if (!branch_length.empty()) {
@@ -22,6 +65,19 @@ double Node::branch_length_as_float() const {
     return 0.0;
 }
 
+std::vector<Node*> Node::siblings() const {
+    std::vector<Node*> res;
+    if (parent != nullptr) {
+        res.reserve(parent->children.size() - 1);
+        for (const auto& child : parent->children) {
+            if (child.get() != this) {
+                res.push_back(child.get());
+            }
+        }
+    }
+    return res;
+}
+
 /*
  * Visit each node in a tree, possibly mutating it.
  */
@@ -33,96 +89,77 @@ void Node::visit(const std::function<void(Node*)>& visitor, const int level) {
 }
 
 
-class Pair {  // Helper class for postorder traversal algorithm.
-public:
-    Node *node;
-    int childrenIndex;
-
-    Pair(Node *_node, const int _childrenIndex)
-        : node {nullptr}, childrenIndex { 0 }
-    {
-        node = _node;
-        childrenIndex = _childrenIndex;
-    }
-};
-
-
+/*
+ * List the nodes of the tree in preorder.
+ */
 std::vector<Node*> Node::traverse() {
     std::vector<Node*> res;
-    res.push_back(this);
-    for (const auto & n: children) {
-        for (auto &i: n->traverse()) {
-            res.push_back(i);
+    std::vector<Node*> stack {this};
+    while (!stack.empty()) {
+        Node* node {stack.back()};
+        stack.pop_back();
+        res.push_back(node);
+        // Push children in reverse order, so that the first child is visited first.
+        for (auto child = node->children.rbegin(); child != node->children.rend(); ++child) {
+            stack.push_back(child->get());
         }
     }
     return res;
 };
 
 
+/*
+ * List the nodes of the tree in postorder. We walk the tree with an explicit stack of
+ * (node, index of the next child to visit) pairs, so the only allocations are the amortised
+ * growth of the stack and the result.
+ */
 std::vector<Node*> Node::postorder_traversal() {
-    int currentIndex = 0;
-    std::stack<Pair*> stack;
-    std::vector<Node*> postorderTraversal ;
-
-    auto current { this };
-
-    while (!stack.empty() || current != nullptr) {
-        if (current != nullptr) {
-            // Traverse down to the leftmost leaf.
-            // Push the current node and its index on the stack
-            stack.push(new Pair(current, currentIndex));
-            currentIndex = 0;
-
-            if (!current->children.empty()) {
-                // Traverse to the leftmost child
-                current = &*current->get_children()[0];
-            } else {
-                // No children, mark current as null and look what's left on the stack.
-                current = nullptr;
-            }
+    std::vector<Node*> postorderTraversal;
+    std::vector<std::pair<Node*, unsigned long>> stack {{this, 0}};
+    while (!stack.empty()) {
+        auto& [node, next_child] {stack.back()};
+        if (next_child < node->children.size()) {
+            Node* child {node->children[next_child].get()};
+            next_child++;
+            stack.emplace_back(child, 0);  // Invalidates `node` and `next_child`.
             continue;
         }
-        // Top node on the stack is returned
-        const Pair* temp = stack.top();
-        stack.pop();
-        postorderTraversal.push_back(temp->node);
-
-        // Now add siblings of the last leaf.
-        while (!stack.empty() && temp->childrenIndex ==
-                static_cast<int>(stack.top()->node->children.size()) - 1)
-        {
-            delete temp;
-            temp = stack.top();
-            stack.pop();
-            postorderTraversal.push_back(temp->node);
-        }
-
-        // If stack is not empty, go one level up, and continue.
-        if (!stack.empty())
-        {
-            current = &*(stack.top()->node)->get_children()[static_cast<unsigned>(temp->childrenIndex) + 1];
-            currentIndex = temp->childrenIndex + 1;
-        }
-        delete temp;
-    };
+        postorderTraversal.push_back(node);
+        stack.pop_back();
+    }
     return postorderTraversal;
 }
 
 
+/*
+ * Turn each polytomy (a1,a2,...,an) into the caterpillar (a1,(a2,(...,(an-1,an)))).
+ */
 Node* Node::resolve_polytomies() {
-    if (this->children.size() > 2) {  // A polytomy.
-        // We insert a new node as parent for all but one child.
-        this->children.emplace_back(std::make_unique<Node>("", ""));
-        // Move all children but the first and the newly created child to the new node.
-        std::move(
-            this->children.begin() + 1,
-            this->children.end() - 1,
-            std::back_inserter(this->children.back()->children));
-        this->children.erase(this->children.begin() + 1, this->children.end() - 1);
-    }
-
-    for (auto &i: this->children) {  // Recurse.
-        i->resolve_polytomies();
+    std::vector<Node*> stack {this};
+    while (!stack.empty()) {
+        Node* node {stack.back()};
+        stack.pop_back();
+        for (const auto& child: node->children) {
+            stack.push_back(child.get());
+        }
+        const unsigned long n {node->children.size()};
+        if (n > 2) {  // A polytomy.
+            // Build the caterpillar for all but the first child bottom-up, ...
+            auto tail {std::make_unique<Node>("", "")};
+            tail->children.reserve(2);
+            tail->add_child(std::move(node->children[n - 2]));
+            tail->add_child(std::move(node->children[n - 1]));
+            for (unsigned long i = n - 2; i > 1; i--) {
+                auto inner {std::make_unique<Node>("", "")};
+                inner->children.reserve(2);
+                inner->add_child(std::move(node->children[i - 1]));
+                inner->add_child(std::move(tail));
+                tail = std::move(inner);
+            }
+            // ... and attach it as second child.
+            node->children.resize(1);
+            node->add_child(std::move(tail));
+        }
     }
     return this;
 }
@@ -131,6 +168,7 @@ Node* Node::resolve_polytomies() {
  * Remove redundant nodes.
  */
 Node* Node::remove_redundant_nodes() {
+    mark_modified();
     for (const auto &n: this->postorder_traversal()) {
         if (n->children.size() == 1) {
             const double length {n->branch_length_as_float() + n->get_children()[0]->branch_length_as_float()};
@@ -138,6 +176,9 @@ Node* Node::remove_redundant_nodes() {
                 n->branch_length = std::to_string(length);
             }
             n->name = n->get_children()[0]->name;
+            for (auto& grandchild : n->children[0]->children) {
+                grandchild->parent = n;
+            }
             std::ranges::move(
                 n->children[0]->children,
                 std::back_inserter(n->children));
@@ -151,28 +192,60 @@ Node* Node::remove_redundant_nodes() {
  * Format the tree as Newick string.
  */
 std::string Node::to_newick(const int level) const {
-    auto newick { std::string("") };
-    if (!this->children.empty()) {
-        newick.append("(");
-        for (auto &n: this->children) {
-            if (newick.back() != '(') {
-                newick.append(",");
-            }
-            newick.append(n->to_newick(level + 1));  // recurse.
-        }
-        newick.append(")");
-    }
-    newick.append(this->name);
-    if (!this->branch_length.empty()) {
-        newick.append(":");
-        newick.append(this->branch_length);
-    }
+    std::string newick;
+    write_newick(newick);
     if (level == 0) {
         newick.append(";");
     }
     return newick;
 }
 
+bool needs_quotes(const std::string_view label) {
+    return label.find_first_of("()[]',:; \t\n\r") != std::string_view::npos;
+}
+
+void append_label(std::string& newick, const std::string_view label) {
+    if (!needs_quotes(label)) {
+        newick.append(label);
+        return;
+    }
+    newick.push_back('\'');
+    for (const char c : label) {
+        if (c == '\'') {
+            newick.push_back('\'');  // Quotes are escaped by doubling.
+        }
+        newick.push_back(c);
+    }
+    newick.push_back('\'');
+}
+
+/*
+ * Append the Newick representation of the tree to `newick`. We walk the tree with an explicit
+ * stack of (node, index of the next child to visit) pairs.
+ */
+void Node::write_newick(std::string& newick) const {
+    std::vector<std::pair<const Node*, unsigned long>> stack {{this, 0}};
+    while (!stack.empty()) {
+        auto& [node, next_child] {stack.back()};
+        if (next_child < node->children.size()) {
+            newick.append(next_child == 0 ? "(" : ",");
+            const Node* child {node->children[next_child].get()};
+            next_child++;
+            stack.emplace_back(child, 0);  // Invalidates `node` and `next_child`.
+            continue;
+        }
+        if (!node->children.empty()) {
+            newick.append(")");
+        }
+        append_label(newick, node->name);
+        if (!node->branch_length.empty()) {
+            newick.append(":");
+            newick.append(node->branch_length);
+        }
+        stack.pop_back();
+    }
+}
+
 
 std::string dashes(unsigned long n) {
     std::string res;
@@ -223,11 +296,31 @@ std::vector<std::string> Node::ascii_art(unsigned long max_len) {
         // We know at least one node (namely `this`) is in `nodes`.
         max_len = (*max_node)->name.size();
     }
+    std::vector lines {reversed_ascii_art(max_len)};
+    for (auto& line : lines) {
+        std::ranges::reverse(line);
+    }
+    return lines;
+}
+
+/*
+ * Prepend `prefix` to a reversed line.
+ */
+static void prepend(std::string& reversed_line, const std::string& prefix) {
+    reversed_line.append(prefix.rbegin(), prefix.rend());
+}
+
+/*
+ * Lines are assembled bottom-up, by prepending the parts contributed by the ancestors. To keep
+ * this linear in the size of the output, we build the lines reversed, so that prepending
+ * becomes appending.
+ */
+std::vector<std::string> Node::reversed_ascii_art(const unsigned long max_len) {
     auto pad {std::string(max_len + 1, ' ')};
     auto lines {std::vector<std::string>()};
 
     if (this->children.empty()) {
-        lines.push_back(this->name);
+        lines.emplace_back(this->name.rbegin(), this->name.rend());
         return lines;
     }
 
@@ -238,9 +331,14 @@ std::vector<std::string> Node::ascii_art(unsigned long max_len) {
 
     for (const auto & n : this->children) {
         // Recursively compute the ascii representation of the child node.
-        std::vector child_lines { n->ascii_art(max_len)};
+        std::vector child_lines { n->reversed_ascii_art(max_len)};
         unsigned long mid {child_lines.size() / 2};
         const bool last_child {n == this->children.back()};
+        std::string previous_pipes;
+        if (child_index == mid_child && even_number_of_children && last_child && mid > 0) {
+            // Lines are moved to `lines` below, so we compute the pipes to continue upfront.
+            previous_pipes = pipes(std::string(child_lines[mid - 1].rbegin(), child_lines[mid - 1].rend()));
+        }
 
         // Loop over child_lines, and pad them or attach the parent name.
         for (unsigned long i = 0; i < child_lines.size(); i++) {
@@ -255,18 +353,16 @@ std::vector<std::string> Node::ascii_art(unsigned long max_len) {
                      * we insert an additional line if there's an even number of children.
                      */
                     mid --;  // Decrement the indicator for the middle line.
-                    if (i > 0) {  // Make sure pipes from the previous line are continued.
-                        lines.push_back(this->name + dashes(max_len + 1 - this->name.size()) + "\u2524" + pipes(child_lines[i - 1]));
-                    } else {
-                        lines.push_back(this->name + dashes(max_len + 1 - this->name.size()) + "\u2524");
-                    }
+                    // Make sure pipes from the previous line are continued.
+                    lines.emplace_back();
+                    prepend(lines.back(), this->name + dashes(max_len + 1 - this->name.size()) + "\u2524" + previous_pipes);
                 } else {
                     full_line = this->name + dashes(max_len - this->name.size()) + "\u2500";
                 }
             }
 
-            const std::string& line {child_lines[i]};
-            if (line.find(' ', 0) == 0) { // line starts with space:
+            std::string& line {child_lines[i]};
+            if (!line.empty() && line.back() == ' ') { // line starts with space:
                 if (in_children) {
                     // - either prepend pipe (if in between first child and last child)
                     full_line.append("\u2502");
@@ -295,7 +391,8 @@ std::vector<std::string> Node::ascii_art(unsigned long max_len) {
                     }
                 }
             }
-            lines.push_back(full_line + line);
+            prepend(line, full_line);
+            lines.push_back(std::move(line));
         }
         child_index++;
     }
@@ -1,37 +1,100 @@
 #ifndef NEWICKCPP_NODE_H
 #define NEWICKCPP_NODE_H
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
+class Node;
+
+/*
+ * The ancestors of a node, from its parent up to the root, following parent links.
+ */
+class AncestorRange {
+    Node* node;
+
+public:
+    class iterator {
+        Node* node;
+
+    public:
+        using value_type = Node*;
+        using difference_type = std::ptrdiff_t;
+        explicit iterator(Node* node = nullptr) : node {node} {}
+        Node* operator*() const { return node; }
+        iterator& operator++();
+        iterator operator++(int) { const iterator it {*this}; ++*this; return it; }
+        bool operator==(const iterator& other) const = default;
+    };
+
+    explicit AncestorRange(Node* parent) : node {parent} {}
+    [[nodiscard]] iterator begin() const { return iterator {node}; }
+    [[nodiscard]] iterator end() const { return iterator {}; }
+};
+
 class Node {
     std::vector<std::unique_ptr<Node>> children;
+    Node* parent { nullptr };
+    unsigned long modifications { 0 };  // Counts operations which remove nodes.
+
+    // Count a removal of nodes below this node, here and at all ancestors, since indexes
+    // watch the root.
+    void mark_modified() noexcept;
+    void write_newick(std::string& newick) const;
+    std::vector<std::string> reversed_ascii_art(unsigned long max_len);
 
 public:
     std::string name;
     std::string branch_length;
     explicit Node(std::string name, std::string branch_length);
-    ~Node() = default;                            // destructor
+    ~Node();                                      // destructor
     // Recommended: Prevent copying of the class instance
     Node(const Node&) = delete;
     Node& operator=(const Node&) = delete;
 
-    // Allow moving the class instance
-    Node(Node&&) = default;
-    Node& operator=(Node&&) = default;
+    // Allow moving the class instance. Children are re-parented, a move-constructed node is
+    // a root, a move-assigned node keeps its place in the tree.
+    Node(Node&& other) noexcept;
+    Node& operator=(Node&& other) noexcept;
 
     void add_child(std::unique_ptr<Node> node) {
+        node->parent = this;
         // Use std::move to transfer ownership to the vector
         children.emplace_back(std::move(node));
     }
 
+    void reserve_children(const unsigned long n) {
+        children.reserve(n);
+    }
+
     // Access elements (e.g., using a raw pointer or reference to const)
     [[nodiscard]] const std::vector<std::unique_ptr<Node>>& get_children() const {
         return children;
     }
 
+    // The parent node, or nullptr for the root.
+    [[nodiscard]] Node* get_parent() const {
+        return parent;
+    }
+    [[nodiscard]] AncestorRange ancestors() const {
+        return AncestorRange {parent};
+    }
+    /*
+     * The other children of the parent node.
+     */
+    [[nodiscard]] std::vector<Node*> siblings() const;
+
+    /*
+     * Incremented by operations on this node or its descendants which remove nodes from the
+     * tree, including moves, so that indexes of the tree can detect that they are stale.
+     */
+    [[nodiscard]] unsigned long get_modifications() const {
+        return modifications;
+    }
+
     [[nodiscard]] double branch_length_as_float() const;
     void visit(const std::function<void(Node*)>& visitor, int level = 0);
     std::vector<Node*> postorder_traversal();
@@ -42,5 +105,20 @@ public:
     std::vector<std::string> ascii_art(unsigned long max_len=0);
 };
 
+/*
+ * Whether a label must be quoted in Newick, as it contains punctuation or whitespace.
+ */
+[[nodiscard]] bool needs_quotes(std::string_view label);
+
+/*
+ * Append a label to `newick`, quoting it if needed. Quotes are escaped by doubling.
+ */
+void append_label(std::string& newick, std::string_view label);
+
+inline AncestorRange::iterator& AncestorRange::iterator::operator++() {
+    node = node->get_parent();
+    return *this;
+}
+
 
 #endif //NEWICKCPP_NODE_H
\ No newline at end of file
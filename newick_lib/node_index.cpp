@@ -0,0 +1,62 @@
+#include <bit>
+#include <functional>
+#include <stdexcept>
+
+#include "node_index.h"
+
+
+NodeIndex::NodeIndex(Node& tree)
+    : tree {tree}
+{
+    rebuild();
+}
+
+void NodeIndex::rebuild() {
+    const std::vector<Node*> nodes { tree.traverse() };
+    slots.assign(std::bit_ceil(2 * nodes.size()), Slot {});
+    count = 0;
+    duplicates.clear();
+    modifications = tree.get_modifications();
+    const std::size_t mask { slots.size() - 1 };
+    for (Node* node : nodes) {
+        if (node->name.empty()) {
+            continue;
+        }
+        const std::uint64_t hash { std::hash<std::string_view> {}(node->name) };
+        for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+            Slot& slot { slots[i] };
+            if (slot.node == nullptr) {
+                slot = Slot {hash, node};
+                count++;
+                break;
+            }
+            if (slot.hash == hash && slot.node->name == node->name) {
+                if (!slot.duplicate) {  // Report each duplicate label once.
+                    slot.duplicate = true;
+                    duplicates.emplace_back(slot.node->name);
+                }
+                break;
+            }
+        }
+    }
+}
+
+Node* NodeIndex::find(const std::string_view label) const {
+    if (tree.get_modifications() != modifications) {
+        throw std::logic_error("NodeIndex is stale, the tree was modified");
+    }
+    if (label.empty()) {
+        return nullptr;
+    }
+    const std::uint64_t hash { std::hash<std::string_view> {}(label) };
+    const std::size_t mask { slots.size() - 1 };
+    for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+        const Slot& slot { slots[i] };
+        if (slot.node == nullptr) {
+            return nullptr;
+        }
+        if (slot.hash == hash && slot.node->name == label) {
+            return slot.node;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef NEWICK_NODE_INDEX_H
+#define NEWICK_NODE_INDEX_H
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "node.h"
+
+/*
+ * Index of the labelled nodes of a tree, for O(1) lookup by label. Built in one pass over the
+ * tree, using an open addressing hash table with linear probing. Labels used for more than
+ * one node are reported as duplicates.
+ *
+ * The index holds pointers to the nodes, so it stays valid as long as no nodes are removed
+ * or relabelled. Adding nodes (e.g. by `resolve_polytomies`) keeps it valid, but the new
+ * nodes aren't indexed. `remove_redundant_nodes` invalidates it, which `find` detects and
+ * reports with std::logic_error; call `rebuild` then.
+ */
+class NodeIndex {
+    struct Slot {
+        std::uint64_t hash { 0 };
+        Node* node { nullptr };  // nullptr for free slots.
+        bool duplicate { false };
+    };
+    Node& tree;
+    unsigned long modifications { 0 };  // Of the tree, when the index was built.
+    std::vector<Slot> slots;  // Size is a power of two.
+    std::size_t count { 0 };
+    std::vector<std::string_view> duplicates;
+
+public:
+    explicit NodeIndex(Node& tree);
+
+    void rebuild();
+    /*
+     * The node with this label - the first in preorder, for duplicate labels - or nullptr.
+     */
+    [[nodiscard]] Node* find(std::string_view label) const;
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+    /*
+     * Labels of more than one node, each listed once.
+     */
+    [[nodiscard]] const std::vector<std::string_view>& get_duplicates() const {
+        return duplicates;
+    }
+};
+
+#endif //NEWICK_NODE_INDEX_H
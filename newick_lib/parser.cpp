@@ -1,12 +1,35 @@
 #include <algorithm>
-#include <cassert>
+#include <charconv>
+#include <expected>
+#include <cstring>
 #include <vector>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 
 #include "node.h"
 #include "parser.h"
 
 
+std::size_t skip_quoted(const std::string_view characters, std::size_t start) {
+    const char closing { characters[start] == '[' ? ']' : '\'' };
+    while (true) {
+        const auto p { static_cast<const char*>(std::memchr(
+            characters.data() + start + 1, closing, characters.size() - start - 1)) };
+        if (p == nullptr) {
+            return std::string_view::npos;
+        }
+        start = static_cast<std::size_t>(p - characters.data());
+        if (closing == '\'' && start + 1 < characters.size() && characters[start + 1] == '\'') {
+            start++;  // An escaped quote.
+            continue;
+        }
+        return start + 1;
+    }
+}
+
 // FIXME: turn into struct?
 Token::Token(char character, const TokenType type, int level)
     : character {character}, type {type}, level {level}
@@ -16,10 +39,40 @@ Token::Token(char character, const TokenType type, int level)
 NewickString::NewickString(const std::vector<char>& characters)
     : tokens { std::vector<Token>()}
 {
+    tokenize(std::string_view(characters.data(), characters.size()));
+};
+
+// We can instantiate NewickString from (subsets of) tokens.
+NewickString::NewickString(std::vector<Token> tokens_)
+    : tokens { std::move(tokens_) }
+{
+    min_level = tokens.empty() ? 0 : tokens[0].level;
+};
+
+// We can instantiate NewickString from a string.
+NewickString::NewickString(const std::string &string)
+    : tokens { std::vector<Token>() }
+{
+    tokenize(string);
+};
+
+void NewickString::tokenize(const std::string_view characters) {
     int level { 0 };
     min_level = 0;
-    for (char character : characters) {
+    tokens.reserve(characters.size());
+    for (std::size_t i = 0; i < characters.size(); i++) {
+        const char character { characters[i] };
         switch (character) {
+            case '\'':
+            case '[': {  // Quoted labels and comments are copied in bulk, up to the closing character.
+                const TokenType type { character == '[' ? TokenType::COMMENT : TokenType::QWORD };
+                const std::size_t end { std::min(skip_quoted(characters, i), characters.size()) };
+                for (; i < end; i++) {
+                    tokens.emplace_back(characters[i], type, level);
+                }
+                i--;
+                break;
+            }
             case ';':
                 //tokens.push_back(Token(character, TokenType::SEMICOLON, level));
                 // FIXME: recognize or raise exception
@@ -36,74 +89,28 @@ NewickString::NewickString(const std::vector<char>& characters)
                 break;
             case ')':
                 level--;
-                assert(level >= 0);
+                if (level < 0) {
+                    throw std::invalid_argument("unbalanced ')' at byte " + std::to_string(i));
+                }
                 tokens.emplace_back(character, TokenType::CBRACE, level);
                 break;
             default:
                 tokens.emplace_back(character, TokenType::CHAR, level);
         }
     }
-};
-
-// We can instantiate NewickString from (subsets of) tokens.
-NewickString::NewickString(const std::vector<Token> &tokens_)
-    : tokens { std::vector<Token>() }
-{
-    for (auto token : tokens_) {
-        tokens.push_back(token);
-    }
-    min_level = tokens[0].level;
-};
-
-// We can instantiate NewickString from a string.
-NewickString::NewickString(const std::string &string)
-    : tokens { std::vector<Token>() }
-{
-    tokens = NewickString(std::vector<char>(string.begin(), string.end())).tokens;
-};
+}
 
+/*
+ * The tokens still hold the characters they were created from, so we can hand them to the
+ * single pass parser.
+ */
 std::unique_ptr<Node> NewickString::to_node() const {
-    auto root_tokens { std::vector<Token>() };
-
-    // Parse root name and length. We traverse the tokens starting at the end, and collect everything
-    // except closing braces until we hit a higher level.
-    for (unsigned long i = tokens.size(); i > 0; i--) {
-        Token token = tokens[i - 1];
-        if (token.character == '\0') {  // Ignore zero-terminator.
-            continue;
-        }
-        if (token.level != min_level) {
-            break;
-        }
-        if (token.type != TokenType::CBRACE) {
-            assert(token.type == TokenType::CHAR || token.type == TokenType::COLON);
-            root_tokens.push_back(token);
-        }
+    std::string characters;
+    characters.reserve(tokens.size());
+    for (const auto& token : tokens) {
+        characters.push_back(token.character);
     }
-    std::ranges::reverse(root_tokens);
-
-    std::string name;
-    std::string length;
-    bool in_name { true };
-    for (auto token : root_tokens) {
-        if (token.type == TokenType::COLON) {
-            in_name = false;
-            continue;
-        }
-        if (in_name) {
-            name.append(std::string(1, token.character));
-        } else {
-            length.append(std::string(1, token.character));
-        }
-    }
-
-    // Instantiate a Node ...
-    auto node {std::make_unique<Node>(name, length)};
-    // ... and add children recursively.
-    for (std::vector descendants { get_descendants() }; auto & descendant : descendants) {
-        node->add_child(descendant.to_node());
-    }
-    return node;
+    return parse(characters);
 };
 
 
@@ -115,18 +122,18 @@ std::vector<NewickString> NewickString::get_descendants() const {
     auto descendant_tokens { std::vector<Token>() };
     bool comma { false };
 
-    for (auto token : tokens) {
+    for (const auto& token : tokens) {
         if (token.type == COMMA && token.level == min_level + 1) {
             // A comma separating immediate children.
             comma = true;
-            descendants.emplace_back(descendant_tokens);
+            descendants.emplace_back(std::move(descendant_tokens));
             descendant_tokens = std::vector<Token>();
         } else if (token.level > min_level) {  // We are on the children level.
-            descendant_tokens.emplace_back(token.character, token.type, token.level);
+            descendant_tokens.push_back(token);
         }
     }
     if (comma || !descendant_tokens.empty()) {
-        descendants.emplace_back(descendant_tokens);
+        descendants.emplace_back(std::move(descendant_tokens));
     }
     return descendants;
 }
@@ -138,6 +145,379 @@ int NewickString::get_min_level() const {
 }
 
 
+/*
+ * Repeated memchr for one character, from increasing start positions. Remembers the last
+ * hit, or how far it searched without one, so that each byte is scanned at most once.
+ */
+class CharFinder {
+    const std::string_view characters;
+    const char character;
+    std::size_t position { 0 };
+    bool found { false };
+    std::size_t searched { 0 };
+
+public:
+    CharFinder(const std::string_view characters, const char character)
+        : characters {characters}, character {character} {
+    }
+
+    // Position of the next occurrence at or after `from`, or any position >= `limit` if
+    // there is none before `limit`.
+    std::size_t next(const std::size_t from, const std::size_t limit) {
+        if (found && position >= from) {
+            return position;
+        }
+        const std::size_t begin { std::max(from, found ? from : searched) };
+        if (begin >= limit) {
+            return limit;
+        }
+        const auto p { static_cast<const char*>(std::memchr(characters.data() + begin, character, limit - begin)) };
+        found = p != nullptr;
+        if (found) {
+            position = static_cast<std::size_t>(p - characters.data());
+            return position;
+        }
+        searched = limit;
+        return limit;
+    }
+};
+
+std::size_t find_tree_end(const std::string_view characters, std::size_t start) {
+    // Most of the input is labels and lengths, so we jump between the characters of interest
+    // with memchr, only searching for quotes and comments before the candidate `;`.
+    CharFinder semicolons {characters, ';'};
+    CharFinder quotes {characters, '\''};
+    CharFinder brackets {characters, '['};
+    while (start < characters.size()) {
+        const std::size_t semicolon { semicolons.next(start, characters.size()) };
+        const std::size_t next { std::min(quotes.next(start, semicolon), brackets.next(start, semicolon)) };
+        if (next >= semicolon) {
+            return semicolon >= characters.size() ? std::string_view::npos : semicolon + 1;
+        }
+        start = skip_quoted(characters, next);
+    }
+    return std::string_view::npos;
+}
+
+static bool is_whitespace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0';
+}
+
+static bool is_delimiter(const char c) {
+    return c == '(' || c == ')' || c == ',' || c == ':' || c == ';' || c == '[';
+}
+
+std::vector<std::string_view> leaf_labels(const std::string_view characters) {
+    std::vector<std::string_view> labels;
+    bool tip { true };  // Whether the next label belongs to a tip.
+    std::size_t i { 0 };
+    while (i < characters.size()) {
+        switch (characters[i]) {
+            case ';':
+                return labels;
+            case '(':
+            case ',':
+                tip = true;
+                i++;
+                break;
+            case ')':
+            case ':':
+                tip = false;
+                i++;
+                break;
+            case '[': {
+                i = std::min(skip_quoted(characters, i), characters.size());
+                break;
+            }
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case '\0':
+                i++;
+                break;
+            default: {
+                std::size_t end { i };
+                if (characters[i] == '\'') {
+                    end = std::min(skip_quoted(characters, i), characters.size());
+                } else {
+                    while (end < characters.size() && !is_delimiter(characters[end])) {
+                        end++;
+                    }
+                    while (end > i && is_whitespace(characters[end - 1])) {
+                        end--;
+                    }
+                }
+                if (tip) {
+                    labels.push_back(characters.substr(i, end - i));
+                    tip = false;
+                }
+                i = end;
+            }
+        }
+    }
+    return labels;
+}
+
+std::string unquote(const std::string_view label) {
+    if (label.size() < 2 || label.front() != '\'' || label.back() != '\'') {
+        return std::string(label);
+    }
+    std::string res;
+    res.reserve(label.size() - 2);
+    for (std::size_t i = 1; i + 1 < label.size(); i++) {
+        res.push_back(label[i]);
+        if (label[i] == '\'' && label[i + 1] == '\'') {
+            i++;  // Skip the second quote of an escaped quote.
+        }
+    }
+    return res;
+}
+
+/*
+ * Validate with a state machine over the tokens of the input, where labels, lengths, quoted
+ * labels and comments are consumed as a whole.
+ */
+std::optional<ParseError> validate(const std::string_view characters) {
+    enum State {
+        node_start,  // After `(`, `,` or at the start of a tree.
+        after_close,  // After `)`.
+        after_label,
+        in_length,  // After `:`.
+        after_length
+    };
+    State state { node_start };
+    long depth { 0 };
+    bool in_tree { false };  // Whether we have seen anything of the current tree.
+    std::size_t i { 0 };
+    while (i < characters.size()) {
+        const char c { characters[i] };
+        if (is_whitespace(c)) {
+            i++;
+            continue;
+        }
+        if (c == '[') {
+            const std::size_t end { skip_quoted(characters, i) };
+            if (end == std::string_view::npos) {
+                return ParseError {i, "unclosed comment"};
+            }
+            i = end;
+            continue;
+        }
+        in_tree = true;
+        switch (c) {
+            case ']':
+                return ParseError {i, "unexpected ']'"};
+            case '(':
+                if (state != node_start) {
+                    return ParseError {i, "unexpected '('"};
+                }
+                depth++;
+                break;
+            case ',':
+            case ')':
+                if (state == in_length) {
+                    return ParseError {i, "missing branch length"};
+                }
+                if (depth == 0) {
+                    return ParseError {i, c == ',' ? "',' outside of braces" : "unbalanced ')'"};
+                }
+                if (c == ')') {
+                    depth--;
+                }
+                state = c == ',' ? node_start : after_close;
+                break;
+            case ':':
+                if (state == in_length || state == after_length) {
+                    return ParseError {i, "unexpected ':'"};
+                }
+                state = in_length;
+                break;
+            case ';':
+                if (state == in_length) {
+                    return ParseError {i, "missing branch length"};
+                }
+                if (depth > 0) {
+                    return ParseError {i, "unbalanced '('"};
+                }
+                state = node_start;
+                in_tree = false;
+                break;
+            case '\'': {
+                if (state != node_start && state != after_close) {
+                    return ParseError {i, "unexpected label"};
+                }
+                const std::size_t end { skip_quoted(characters, i) };
+                if (end == std::string_view::npos) {
+                    return ParseError {i, "unclosed quote"};
+                }
+                state = after_label;
+                i = end;
+                continue;
+            }
+            default: {
+                std::size_t end { i };
+                while (end < characters.size() && !is_delimiter(characters[end]) && characters[end] != '\''
+                        && characters[end] != ']') {
+                    end++;
+                }
+                if (end < characters.size() && (characters[end] == '\'' || characters[end] == ']')) {
+                    return ParseError {end, characters[end] == ']' ? "unexpected ']'" : "unexpected quote"};
+                }
+                std::size_t last { end };
+                while (is_whitespace(characters[last - 1])) {
+                    last--;
+                }
+                if (state == in_length) {
+                    double length;
+                    const auto [p, error] { std::from_chars(characters.data() + i, characters.data() + last, length) };
+                    if (error != std::errc() || p != characters.data() + last) {
+                        return ParseError {i, "invalid branch length"};
+                    }
+                    state = after_length;
+                } else if (state == node_start || state == after_close) {
+                    state = after_label;
+                } else {
+                    return ParseError {i, "unexpected label"};
+                }
+                i = end;
+                continue;
+            }
+        }
+        i++;
+    }
+    if (in_tree) {
+        return ParseError {characters.size(), "missing ';'"};
+    }
+    return std::nullopt;
+}
+
+/*
+ * Parse a Newick string in a single pass, keeping the chain of currently open nodes on an
+ * explicit stack. Thus, running time is linear in the input size, and deeply nested trees
+ * do not exhaust the call stack.
+ *
+ * Whitespace around labels and lengths is ignored, parsing stops at the first `;`. Quoted
+ * labels and comments are skipped with memchr, since in annotated trees (e.g. from BEAST) most
+ * of the input is comments.
+ */
+static std::expected<std::unique_ptr<Node>, ParseError> parse_tree(
+        const std::string_view characters, std::vector<Comment>* comments) {
+    auto root {std::make_unique<Node>("", "")};
+    Node* current {root.get()};  // The node whose label and length we read.
+    std::vector<Node*> open;  // Ancestors of `current`.
+    bool in_length { false };
+
+    std::size_t i { 0 };
+    while (i < characters.size()) {
+        const char c { characters[i] };
+        if (is_whitespace(c)) {
+            i++;
+            continue;
+        }
+        if (c == ';') {
+            break;
+        }
+        switch (c) {
+            case '(':
+                open.push_back(current);
+                current->reserve_children(2);  // Most trees are binary.
+                current->add_child(std::make_unique<Node>("", ""));
+                current = current->get_children().back().get();
+                in_length = false;
+                break;
+            case ',':
+                if (open.empty()) {
+                    return std::unexpected(ParseError {i, "',' outside of braces"});
+                }
+                open.back()->add_child(std::make_unique<Node>("", ""));
+                current = open.back()->get_children().back().get();
+                in_length = false;
+                break;
+            case ')':
+                if (open.empty()) {
+                    return std::unexpected(ParseError {i, "unbalanced ')'"});
+                }
+                current = open.back();
+                open.pop_back();
+                in_length = false;
+                break;
+            case ':':
+                in_length = true;
+                break;
+            case '[': {
+                const std::size_t end { skip_quoted(characters, i) };
+                if (end == std::string_view::npos) {
+                    return std::unexpected(ParseError {i, "unclosed comment"});
+                }
+                if (comments != nullptr) {
+                    comments->push_back(Comment {current, characters.substr(i + 1, end - i - 2)});
+                }
+                i = end;
+                continue;
+            }
+            case '\'':
+                if (!in_length) {
+                    const std::size_t end { skip_quoted(characters, i) };
+                    if (end == std::string_view::npos) {
+                        return std::unexpected(ParseError {i, "unclosed quote"});
+                    }
+                    current->name = unquote(characters.substr(i, end - i));
+                    i = end;
+                    continue;
+                }
+                [[fallthrough]];
+            default: {
+                // Read a label or length as a whole, up to the next delimiter.
+                std::size_t end { i };
+                while (end < characters.size() && !is_delimiter(characters[end])) {
+                    end++;
+                }
+                std::size_t last { end };
+                while (is_whitespace(characters[last - 1])) {
+                    last--;
+                }
+                (in_length ? current->branch_length : current->name).assign(characters.substr(i, last - i));
+                i = end;
+                continue;
+            }
+        }
+        i++;
+    }
+    if (!open.empty()) {
+        return std::unexpected(ParseError {i, "unbalanced '('"});
+    }
+    return root;
+}
+
+static std::unique_ptr<Node> value_or_throw(std::expected<std::unique_ptr<Node>, ParseError> tree) {
+    if (!tree) {
+        throw std::invalid_argument(
+            std::string(tree.error().reason) + " at byte " + std::to_string(tree.error().offset));
+    }
+    return std::move(*tree);
+}
+
+std::unique_ptr<Node> parse(const std::string_view characters) {
+    return value_or_throw(parse_tree(characters, nullptr));
+}
+
+std::unique_ptr<Node> parse(const std::string_view characters, std::vector<Comment>& comments) {
+    return value_or_throw(parse_tree(characters, &comments));
+}
+
+/*
+ * Validating first is cheap compared to building the nodes, and makes sure we accept exactly
+ * the trees `validate` accepts.
+ */
+std::expected<std::unique_ptr<Node>, ParseError> try_parse(const std::string_view characters) {
+    const std::size_t end { find_tree_end(characters) };
+    if (const auto error { validate(end == std::string_view::npos ? characters : characters.substr(0, end)) }) {
+        return std::unexpected(*error);
+    }
+    return parse_tree(characters, nullptr);
+}
+
 std::unique_ptr<Node> parse(const std::vector<char>& characters) {
-    return NewickString(characters).to_node();
+    return parse(std::string_view(characters.data(), characters.size()));
 }
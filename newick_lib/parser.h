@@ -1,7 +1,11 @@
 #ifndef NEWICK_PARSER_H
 #define NEWICK_PARSER_H
 
+#include <expected>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "node.h"
 
@@ -27,17 +31,83 @@ public:
 
 class NewickString {
     int min_level { 0 };
+    void tokenize(std::string_view characters);
 public:
     std::vector<Token> tokens;
 
     explicit NewickString(const std::vector<char>& characters);
-    explicit NewickString(const std::vector<Token> &tokens);
+    explicit NewickString(std::vector<Token> tokens);
     explicit NewickString(const std::string &string);
     [[nodiscard]] std::unique_ptr<Node> to_node() const;
     [[nodiscard]] int get_min_level() const;
     [[nodiscard]] std::vector<NewickString> get_descendants() const;
 };
 
+/*
+ * Find the end of the tree starting at `start`, i.e. the position right after the next `;`
+ * which is neither part of a quoted label nor of a comment. Returns std::string_view::npos if
+ * there is no such `;`. No nodes are built.
+ */
+[[nodiscard]] std::size_t find_tree_end(std::string_view characters, std::size_t start = 0);
+
+/*
+ * The labels of the tips of the first tree in `characters`, as spans of the input (quoted
+ * labels keep their quotes). Tips are found by scanning the tokens, without building nodes:
+ * labels which follow `(` or `,` (or start the tree) belong to tips. Unlabelled tips are
+ * skipped. The input is not validated.
+ */
+[[nodiscard]] std::vector<std::string_view> leaf_labels(std::string_view characters);
+
+/*
+ * Skip over the quoted label or comment starting at `start`, returning the position after
+ * the closing character, or npos if it isn't closed.
+ */
+[[nodiscard]] std::size_t skip_quoted(std::string_view characters, std::size_t start);
+
+/*
+ * Strip the quotes from a quoted label, replacing escaped quotes ('') with single ones.
+ * Unquoted labels are returned unchanged.
+ */
+[[nodiscard]] std::string unquote(std::string_view label);
+
+/*
+ * The byte offset in the input where parsing failed, and why.
+ */
+struct ParseError {
+    std::size_t offset;
+    const char* reason;
+};
+
+/*
+ * Check that `characters` consists of well-formed trees, each terminated by `;`, without
+ * building any nodes or allocating memory. Returns the first error, or std::nullopt for valid
+ * input.
+ */
+[[nodiscard]] std::optional<ParseError> validate(std::string_view characters);
+
+/*
+ * A comment, e.g. a BEAST annotation like `[&rate=0.1]`, as span of the parsed input without
+ * the brackets, together with the node it follows. Comments are not copied, so the spans are
+ * only valid as long as the input.
+ */
+struct Comment {
+    const Node* node;
+    std::string_view text;
+};
+
+/*
+ * Parse the first tree in `characters`. Quoted labels are unquoted, comments are skipped or,
+ * if `comments` is passed, collected as spans. Throws std::invalid_argument for unbalanced
+ * braces, unclosed quotes or comments.
+ */
+std::unique_ptr<Node> parse(std::string_view characters);
+std::unique_ptr<Node> parse(std::string_view characters, std::vector<Comment>& comments);
+
+/*
+ * Parse the first tree in `characters`, which must be terminated by `;`, returning the first
+ * error `validate` finds instead of throwing.
+ */
+[[nodiscard]] std::expected<std::unique_ptr<Node>, ParseError> try_parse(std::string_view characters);
 std::unique_ptr<Node> parse(const std::vector<char>& characters);
 
 #endif //NEWICK_PARSER_H
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "profile.h"
+
+
+static std::atomic<unsigned long> allocations { 0 };
+static std::atomic<unsigned long> allocated_bytes { 0 };
+
+void count_allocation(const std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+unsigned long allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+unsigned long allocation_bytes() {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+long peak_rss_kb() {
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;  // Linux reports KiB.
+}
+
+
+void Profile::start(const std::string& name) {
+    phases.push_back(Phase {name, 0.0, 0.0, 0, 0, static_cast<unsigned>(open.size())});
+    OpenPhase& phase { open.emplace_back() };
+    phase.index = phases.size() - 1;
+    // Read the counters last, so that the bookkeeping above is not attributed to the phase.
+    phase.allocations_start = allocation_count();
+    phase.bytes_start = allocation_bytes();
+    phase.cpu_start = std::clock();
+    phase.wall_start = std::chrono::steady_clock::now();
+}
+
+void Profile::stop() {
+    const auto wall_end { std::chrono::steady_clock::now() };
+    const auto cpu_end { std::clock() };
+    const OpenPhase& started { open.back() };
+    Phase& phase { phases[started.index] };
+    phase.wall_seconds = std::chrono::duration<double>(wall_end - started.wall_start).count();
+    phase.cpu_seconds = static_cast<double>(cpu_end - started.cpu_start) / CLOCKS_PER_SEC;
+    phase.allocations = allocation_count() - started.allocations_start;
+    phase.allocated_bytes = allocation_bytes() - started.bytes_start;
+    open.pop_back();
+}
+
+double Profile::wall_seconds() const {
+    double total { 0.0 };
+    for (const auto& phase : phases) {
+        if (phase.depth == 0) {  // Nested phases are part of their enclosing phase.
+            total += phase.wall_seconds;
+        }
+    }
+    return total;
+}
+
+/*
+ * Format the profile as aligned table, e.g.
+ *
+ * phase                   wall[s]     cpu[s]     allocs      bytes
+ * read_file              0.000012   0.000011          3       4152
+ *
+ * with nested phases indented below their enclosing phase.
+ */
+std::string Profile::to_text() const {
+    std::ostringstream out;
+    char line[128];
+    std::snprintf(line, sizeof line, "%-24s %10s %10s %10s %12s\n", "phase", "wall[s]", "cpu[s]", "allocs", "bytes");
+    out << line;
+    for (const auto& phase : phases) {
+        std::snprintf(
+            line, sizeof line, "%-24s %10.6f %10.6f %10lu %12lu\n",
+            (std::string(2 * phase.depth, ' ') + phase.name).c_str(), phase.wall_seconds, phase.cpu_seconds, phase.allocations, phase.allocated_bytes);
+        out << line;
+    }
+    const double total { wall_seconds() };
+    out << "input bytes: " << bytes << "\n";
+    out << "trees: " << trees << "\n";
+    out << "trees/s: " << (total > 0 ? static_cast<double>(trees) / total : 0.0) << "\n";
+    out << "nodes: " << nodes << "\n";
+    out << "peak rss [KiB]: " << peak_rss_kb() << "\n";
+    out << "allocations: " << allocation_count() << "\n";
+    return out.str();
+}
+
+std::string Profile::to_json() const {
+    std::ostringstream out;
+    out << "{\"phases\": [";
+    for (unsigned long i = 0; i < phases.size(); i++) {
+        const auto& phase { phases[i] };
+        if (i > 0) {
+            out << ", ";
+        }
+        // Phase names are identifiers chosen by the caller, so they need no escaping.
+        out << "{\"name\": \"" << phase.name << "\""
+            << ", \"wall_seconds\": " << phase.wall_seconds
+            << ", \"cpu_seconds\": " << phase.cpu_seconds
+            << ", \"allocations\": " << phase.allocations
+            << ", \"allocated_bytes\": " << phase.allocated_bytes
+            << ", \"depth\": " << phase.depth << "}";
+    }
+    const double total { wall_seconds() };
+    out << "], \"bytes\": " << bytes
+        << ", \"trees\": " << trees
+        << ", \"trees_per_second\": " << (total > 0 ? static_cast<double>(trees) / total : 0.0)
+        << ", \"nodes\": " << nodes
+        << ", \"peak_rss_kb\": " << peak_rss_kb()
+        << ", \"allocations\": " << allocation_count()
+        << ", \"allocated_bytes\": " << allocation_bytes() << "}";
+    return out.str();
+}
@@ -0,0 +1,81 @@
+#ifndef NEWICK_PROFILE_H
+#define NEWICK_PROFILE_H
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Process wide allocation counters. They are only incremented in binaries which link the
+ * replacement `operator new` from alloc_hooks.cpp (target `newick_alloc_hooks`), otherwise
+ * they stay at zero.
+ */
+void count_allocation(std::size_t size);
+[[nodiscard]] unsigned long allocation_count();
+[[nodiscard]] unsigned long allocation_bytes();
+
+/*
+ * Peak resident set size of the process in KiB.
+ */
+[[nodiscard]] long peak_rss_kb();
+
+struct Phase {
+    std::string name;
+    double wall_seconds;
+    double cpu_seconds;
+    unsigned long allocations;
+    unsigned long allocated_bytes;
+    unsigned depth { 0 };  // Number of enclosing phases.
+};
+
+/*
+ * Collects wall and CPU time, and allocation counts per named phase of a run. Phases may be
+ * nested; an enclosing phase includes the costs of the phases within it.
+ */
+class Profile {
+    struct OpenPhase {
+        std::size_t index;  // Into `phases`.
+        std::chrono::steady_clock::time_point wall_start;
+        std::clock_t cpu_start;
+        unsigned long allocations_start;
+        unsigned long bytes_start;
+    };
+    std::vector<Phase> phases;
+    std::vector<OpenPhase> open;  // Innermost last.
+
+public:
+    unsigned long bytes { 0 };  // Number of input bytes processed.
+    unsigned long trees { 0 };
+    unsigned long nodes { 0 };
+
+    void start(const std::string& name);
+    void stop();
+
+    /*
+     * Run `function` as phase `name`, returning its result.
+     */
+    template <typename Function>
+    auto measure(const std::string& name, Function&& function) {
+        start(name);
+        if constexpr (std::is_void_v<std::invoke_result_t<Function>>) {
+            function();
+            stop();
+        } else {
+            auto result { function() };
+            stop();
+            return result;
+        }
+    }
+
+    [[nodiscard]] const std::vector<Phase>& get_phases() const {
+        return phases;
+    }
+    // Of the outermost phases.
+    [[nodiscard]] double wall_seconds() const;
+    [[nodiscard]] std::string to_text() const;
+    [[nodiscard]] std::string to_json() const;
+};
+
+#endif //NEWICK_PROFILE_H
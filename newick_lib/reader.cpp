@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "parser.h"
+#include "reader.h"
+
+
+TreeReader::TreeReader(const std::string_view input)
+    : input {input} {
+}
+
+std::optional<std::string_view> TreeReader::next_newick() {
+    while (position < input.size() && std::isspace(static_cast<unsigned char>(input[position]))) {
+        position++;
+    }
+    if (position >= input.size()) {
+        return std::nullopt;
+    }
+    // Trailing input without `;` is returned as (invalid) tree, so that it isn't lost silently.
+    const std::size_t end { std::min(find_tree_end(input, position), input.size()) };
+    const std::string_view newick { input.substr(position, end - position) };
+    position = end;
+    return newick;
+}
+
+std::unique_ptr<Node> TreeReader::next() {
+    const auto newick { next_newick() };
+    if (!newick) {
+        return nullptr;
+    }
+    return parse(*newick);
+}
+
+bool TreeReader::skip() {
+    return next_newick().has_value();
+}
+
+std::size_t TreeReader::count() {
+    std::size_t n { 0 };
+    while (skip()) {
+        n++;
+    }
+    return n;
+}
+
+
+std::size_t burnin_trees(const std::string& burnin, const std::size_t total) {
+    if (burnin.empty()) {
+        return 0;
+    }
+    if (burnin.back() == '%') {
+        const double percent { std::stod(burnin.substr(0, burnin.size() - 1)) };
+        if (percent < 0 || percent > 100) {
+            throw std::invalid_argument("burn-in must be between 0% and 100%");
+        }
+        return static_cast<std::size_t>(static_cast<double>(total) * percent / 100.0);
+    }
+    return std::stoul(burnin);
+}
+
+void sample_trees(TreeReader& reader, const std::size_t burnin, const std::size_t every,
+                  const std::function<void(std::string_view)>& visitor) {
+    for (std::size_t i = 0; i < burnin; i++) {
+        if (!reader.skip()) {
+            return;
+        }
+    }
+    while (const auto newick { reader.next_newick() }) {
+        visitor(*newick);
+        for (std::size_t i = 1; i < every; i++) {
+            if (!reader.skip()) {
+                return;
+            }
+        }
+    }
+}
+
+std::size_t parse_batch(TreeReader& reader, const std::function<void(Node&)>& visitor,
+                        const std::function<void(std::size_t, const ParseError&)>& on_error) {
+    std::size_t errors { 0 };
+    for (std::size_t i = 0; const auto newick { reader.next_newick() }; i++) {
+        auto tree { try_parse(*newick) };
+        if (tree) {
+            visitor(**tree);
+        } else {
+            errors++;
+            on_error(i, ParseError {reader.offset(*newick) + tree.error().offset, tree.error().reason});
+        }
+    }
+    return errors;
+}
+
+void parse_parallel(TreeReader& reader, const unsigned threads,
+                    const std::function<void(unsigned, std::string_view, Node&)>& visitor) {
+    constexpr std::size_t batch {64};
+    std::mutex mutex;
+    std::exception_ptr error;
+    const auto work {[&](const unsigned thread) {
+        std::vector<std::string_view> newicks;
+        try {
+            while (true) {
+                newicks.clear();
+                {
+                    const std::lock_guard lock {mutex};
+                    while (error == nullptr && newicks.size() < batch) {
+                        const auto newick {reader.next_newick()};
+                        if (!newick) {
+                            break;
+                        }
+                        newicks.push_back(*newick);
+                    }
+                }
+                if (newicks.empty()) {
+                    return;
+                }
+                for (const std::string_view newick : newicks) {
+                    const std::unique_ptr<Node> tree {parse(newick)};
+                    visitor(thread, newick, *tree);
+                }
+            }
+        } catch (...) {
+            const std::lock_guard lock {mutex};
+            if (error == nullptr) {
+                error = std::current_exception();
+            }
+        }
+    }};
+    std::vector<std::thread> workers;
+    for (unsigned thread = 1; thread < std::max(threads, 1U); thread++) {
+        workers.emplace_back(work, thread);
+    }
+    work(0);  // Thread 0 is the calling thread.
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
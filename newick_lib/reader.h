@@ -0,0 +1,81 @@
+#ifndef NEWICK_READER_H
+#define NEWICK_READER_H
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "node.h"
+#include "parser.h"
+
+/*
+ * Reads the trees of a multi-tree input one by one. Trees can be skipped without building
+ * any nodes, by just scanning for the terminating `;`.
+ */
+class TreeReader {
+protected:
+    std::string_view input;
+    std::size_t position { 0 };
+
+public:
+    explicit TreeReader(std::string_view input);
+    virtual ~TreeReader() = default;
+
+    /*
+     * The Newick string of the next tree, including the terminating `;`, or std::nullopt if
+     * there are no more trees.
+     */
+    virtual std::optional<std::string_view> next_newick();
+    /*
+     * The next tree, or nullptr if there are no more trees. Throws std::invalid_argument for
+     * malformed trees.
+     */
+    std::unique_ptr<Node> next();
+    /*
+     * Skip the next tree. Returns false if there was no tree left.
+     */
+    bool skip();
+    /*
+     * Skip all remaining trees, returning their number.
+     */
+    std::size_t count();
+    /*
+     * Byte offset of a string returned by next_newick in the input.
+     */
+    [[nodiscard]] std::size_t offset(const std::string_view newick) const {
+        return static_cast<std::size_t>(newick.data() - input.data());
+    }
+};
+
+/*
+ * Number of burn-in trees, specified either as absolute number or as percentage of `total`,
+ * e.g. "1000" or "10%".
+ */
+[[nodiscard]] std::size_t burnin_trees(const std::string& burnin, std::size_t total);
+
+/*
+ * Call `visitor` for every `every`th tree after skipping `burnin` trees.
+ */
+void sample_trees(TreeReader& reader, std::size_t burnin, std::size_t every,
+                  const std::function<void(std::string_view)>& visitor);
+
+/*
+ * Parse all remaining trees, calling `visitor` for each well-formed tree and `on_error` with
+ * the index of the tree and the error - with the offset relative to the whole input - for
+ * each malformed one. Returns the number of malformed trees.
+ */
+std::size_t parse_batch(TreeReader& reader, const std::function<void(Node&)>& visitor,
+                        const std::function<void(std::size_t, const ParseError&)>& on_error);
+
+/*
+ * Parse all remaining trees on `threads` threads, calling `visitor` with the number of the
+ * thread, in [0, threads), the Newick string and the tree. Threads take batches of Newick strings from the
+ * reader, so the order of the trees is lost. The first exception thrown by the parser or the
+ * visitor stops all threads and is rethrown.
+ */
+void parse_parallel(TreeReader& reader, unsigned threads,
+                    const std::function<void(unsigned, std::string_view, Node&)>& visitor);
+
+#endif //NEWICK_READER_H
@@ -0,0 +1,171 @@
+#include <bit>
+#include <functional>
+#include <stdexcept>
+
+#include "node.h"
+#include "parser.h"
+#include "rename.h"
+
+
+std::uint64_t LabelMap::hash(const std::string_view label) {
+    return std::hash<std::string_view> {}(label);
+}
+
+
+LabelMap::LabelMap(const std::string_view tsv) {
+    // Size the table for a load factor of at most 1/2, based on the number of lines.
+    std::size_t lines { 1 };
+    for (const char c : tsv) {
+        lines += c == '\n';
+    }
+    slots.resize(std::bit_ceil(2 * lines));
+
+    std::size_t start { 0 };
+    while (start < tsv.size()) {
+        std::size_t end { tsv.find('\n', start) };
+        if (end == std::string_view::npos) {
+            end = tsv.size();
+        }
+        std::string_view line { tsv.substr(start, end - start) };
+        start = end + 1;
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t tab { line.find('\t') };
+        if (tab == std::string_view::npos || tab == 0) {
+            throw std::runtime_error("invalid mapping line: " + std::string(line));
+        }
+        std::string_view value { line.substr(tab + 1) };
+        if (needs_quotes(value)) {
+            std::string& label { quoted.emplace_back() };
+            append_label(label, value);
+            value = label;
+        }
+        insert(line.substr(0, tab), value);
+    }
+}
+
+void LabelMap::insert(const std::string_view key, const std::string_view value) {
+    const std::uint64_t full { hash(key) };
+    const auto h { static_cast<std::uint32_t>(full) };
+    const std::size_t mask { slots.size() - 1 };
+    for (std::size_t i = full >> 32 & mask; ; i = (i + 1) & mask) {
+        Slot& slot { slots[i] };
+        if (slot.key == nullptr) {
+            slot = Slot {key.data(), static_cast<std::uint32_t>(key.size()), h, value.data(), value.size()};
+            count++;
+            return;
+        }
+        if (slot.hash == h && std::string_view(slot.key, slot.key_size) == key) {
+            slot.value = value.data();
+            slot.value_size = value.size();
+            return;
+        }
+    }
+}
+
+std::optional<std::string_view> LabelMap::find(const std::string_view label, const std::uint64_t full) const {
+    if (label.empty()) {
+        return std::nullopt;
+    }
+    const auto h { static_cast<std::uint32_t>(full) };
+    const std::size_t mask { slots.size() - 1 };
+    for (std::size_t i = full >> 32 & mask; ; i = (i + 1) & mask) {
+        const Slot& slot { slots[i] };
+        if (slot.key == nullptr) {
+            return std::nullopt;
+        }
+        if (slot.hash == h && std::string_view(slot.key, slot.key_size) == label) {
+            return std::string_view(slot.value, slot.value_size);
+        }
+    }
+}
+
+void LabelMap::prefetch_slot(const std::uint64_t full) const {
+    __builtin_prefetch(&slots[full >> 32 & (slots.size() - 1)]);
+}
+
+void LabelMap::prefetch_key(const std::uint64_t full) const {
+    const Slot& slot { slots[full >> 32 & (slots.size() - 1)] };
+    if (slot.key != nullptr) {
+        __builtin_prefetch(slot.key);
+    }
+}
+
+
+Renamer::Renamer(std::ostream& out, const LabelMap& map)
+    : NewickWriter {out}, map {map}
+{
+}
+
+Renamer::~Renamer() {
+    drain();
+}
+
+void Renamer::write(const Event& event) {
+    switch (event.type) {
+        case open_event:
+            NewickWriter::on_open();
+            break;
+        case leaf_event:
+            NewickWriter::on_leaf(map.find(event.label, event.hash).value_or(event.label), event.length);
+            break;
+        case close_event:
+            NewickWriter::on_close(event.label, event.length);
+            break;
+    }
+}
+
+void Renamer::push(const Event& event) {
+    if (pending == WINDOW) {
+        write(window[first]);
+        first = (first + 1) % WINDOW;
+        pending--;
+    }
+    window[(first + pending) % WINDOW] = event;
+    pending++;
+    if (event.type == leaf_event) {
+        map.prefetch_slot(event.hash);
+    }
+    // Half-way through the window, the slot should have arrived.
+    if (const Event& middle { window[(first + pending / 2) % WINDOW] }; middle.type == leaf_event) {
+        map.prefetch_key(middle.hash);
+    }
+}
+
+void Renamer::drain() {
+    for (; pending > 0; pending--) {
+        write(window[first]);
+        first = (first + 1) % WINDOW;
+    }
+}
+
+void Renamer::on_open() {
+    push(Event {open_event, {}, {}, 0});
+}
+
+void Renamer::on_leaf(const std::string_view label, const std::string_view length) {
+    if (label.starts_with('\'')) {  // Rare, so we can afford to allocate, and to wait.
+        drain();
+        NewickWriter::on_leaf(map.find(unquote(label)).value_or(label), length);
+        return;
+    }
+    push(Event {leaf_event, label, length, LabelMap::hash(label)});
+}
+
+void Renamer::on_close(const std::string_view label, const std::string_view length) {
+    push(Event {close_event, label, length, 0});
+}
+
+void Renamer::on_tree_end() {
+    drain();
+    NewickWriter::on_tree_end();
+}
+
+void Renamer::flush() {
+    drain();
+    NewickWriter::flush();
+}
@@ -0,0 +1,101 @@
+#ifndef NEWICK_RENAME_H
+#define NEWICK_RENAME_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "events.h"
+
+/*
+ * Mapping of old to new labels, read from tab-separated `old<TAB>new` lines. Lookups go
+ * through an open addressing hash table with linear probing, which stores the hashes next to
+ * the keys, so that most probes do not touch the label bytes.
+ *
+ * Keys and values are spans of the mapping text, which must outlive the map.
+ */
+class LabelMap {
+    // Packed into 32 bytes, so that a probe touches a single cache line.
+    struct alignas(32) Slot {
+        const char* key { nullptr };  // nullptr for free slots.
+        std::uint32_t key_size { 0 };
+        std::uint32_t hash { 0 };
+        const char* value { nullptr };
+        std::size_t value_size { 0 };
+    };
+    std::vector<Slot> slots;  // Size is a power of two.
+    std::size_t count { 0 };
+    std::deque<std::string> quoted;  // Values which must be quoted in Newick; stable addresses.
+
+    void insert(std::string_view key, std::string_view value);
+
+public:
+    /*
+     * Throws std::runtime_error for lines without tab or with an empty key. Later lines
+     * override earlier ones with the same key.
+     */
+    explicit LabelMap(std::string_view tsv);
+
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+    /*
+     * The new label, ready to be written as Newick (i.e. quoted if necessary).
+     */
+    [[nodiscard]] std::optional<std::string_view> find(std::string_view label) const {
+        return find(label, hash(label));
+    }
+    [[nodiscard]] std::optional<std::string_view> find(std::string_view label, std::uint64_t hash) const;
+    [[nodiscard]] static std::uint64_t hash(std::string_view label);
+    /*
+     * Prefetch the first slot probed for a hash, and - once that is in the cache - the key
+     * stored in it. For a large map, lookups are dominated by cache misses, which we can
+     * overlap by prefetching ahead of the actual lookup.
+     */
+    void prefetch_slot(std::uint64_t hash) const;
+    void prefetch_key(std::uint64_t hash) const;
+};
+
+/*
+ * Streaming transform writing the trees with leaves relabelled according to a LabelMap.
+ * Leaves without a mapping, and inner nodes, keep their labels.
+ */
+class Renamer : public NewickWriter {
+    // Events are delayed in a small window, so that the lookups of later leaves can be
+    // prefetched while we wait for earlier ones.
+    enum EventType { open_event, leaf_event, close_event };
+    struct Event {
+        EventType type;
+        std::string_view label;
+        std::string_view length;
+        std::uint64_t hash;
+    };
+    static constexpr std::size_t WINDOW { 16 };
+
+    const LabelMap& map;
+    std::array<Event, WINDOW> window {};
+    std::size_t first { 0 };
+    std::size_t pending { 0 };
+
+    void push(const Event& event);
+    void write(const Event& event);
+    void drain();
+
+public:
+    Renamer(std::ostream& out, const LabelMap& map);
+    ~Renamer() override;
+
+    void on_open() override;
+    void on_leaf(std::string_view label, std::string_view length) override;
+    void on_close(std::string_view label, std::string_view length) override;
+    void on_tree_end() override;
+    // Also writes the events still waiting in the window.
+    void flush() override;
+};
+
+#endif //NEWICK_RENAME_H
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "rf.h"
+
+
+void RobinsonFoulds::add(const Node& tree) {
+    if (size() == 0) {
+        taxa = TaxonIndex(tree);
+    }
+    const Splits splits {tree, taxa};
+    if (splits.tips() != taxa.size()) {
+        throw std::invalid_argument("tree " + label(size()) + " has different taxa than tree 1");
+    }
+    const std::size_t first {ids.size()};
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        const std::uint32_t id {table.insert(splits.hash(i))};
+        if (id == trees.size()) {
+            trees.emplace_back();
+        }
+        trees[id].push_back(static_cast<std::uint32_t>(size()));
+        ids.push_back(id);
+    }
+    std::sort(ids.begin() + static_cast<std::ptrdiff_t>(first), ids.end());
+    offsets.push_back(ids.size());
+}
+
+std::size_t RobinsonFoulds::common(const std::size_t i, const std::size_t j) const {
+    const std::uint32_t* a {ids.data() + offsets[i]};
+    const std::uint32_t* const a_end {ids.data() + offsets[i + 1]};
+    const std::uint32_t* b {ids.data() + offsets[j]};
+    const std::uint32_t* const b_end {ids.data() + offsets[j + 1]};
+    std::size_t count {0};
+    while (a != a_end && b != b_end) {  // Branch free, as the comparisons are unpredictable.
+        const std::uint32_t x {*a};
+        const std::uint32_t y {*b};
+        count += x == y;
+        a += x <= y;
+        b += y <= x;
+    }
+    return count;
+}
+
+std::size_t RobinsonFoulds::distance(const std::size_t i, const std::size_t j) const {
+    return splits(i) + splits(j) - 2 * common(i, j);
+}
+
+double RobinsonFoulds::normalized_distance(const std::size_t i, const std::size_t j) const {
+    const std::size_t total {splits(i) + splits(j)};
+    return total == 0 ? 0.0 : static_cast<double>(distance(i, j)) / static_cast<double>(total);
+}
+
+template<typename T>
+void RobinsonFoulds::rows(const std::size_t first, const std::size_t last, T* out, const unsigned threads) const {
+    if (first >= last) {
+        return;
+    }
+    const std::size_t n {size()};
+    const std::size_t chunk {(last - first + std::max(threads, 1U) - 1) / std::max(threads, 1U)};
+    std::vector<std::thread> workers;
+    for (std::size_t start = first; start < last; start += chunk) {
+        const std::size_t end {std::min(start + chunk, last)};
+        const auto work {[this, start, end, first, n, out] {
+            std::vector<std::uint32_t> shared(n);
+            for (std::size_t i = start; i < end; i++) {
+                std::fill(shared.begin(), shared.end(), 0);
+                for (std::size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+                    for (const std::uint32_t j : trees[ids[k]]) {
+                        shared[j]++;
+                    }
+                }
+                T* const row {out + (i - first) * n};
+                const double own {static_cast<double>(splits(i))};
+                for (std::size_t j = 0; j < n; j++) {
+                    const double total {own + static_cast<double>(splits(j))};
+                    const double rf {total - 2.0 * shared[j]};
+                    row[j] = static_cast<T>(normalize ? (total == 0 ? 0.0 : rf / total) : rf);
+                }
+            }
+        }};
+        if (end == last) {
+            work();  // The last chunk runs on the calling thread.
+        } else {
+            workers.emplace_back(work);
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+template void RobinsonFoulds::rows<float>(std::size_t, std::size_t, float*, unsigned) const;
+template void RobinsonFoulds::rows<double>(std::size_t, std::size_t, double*, unsigned) const;
+
+
+void write_rf(const RobinsonFoulds& rf, std::ostream& out, const DistanceFormat format, const unsigned threads) {
+    write_matrix(rf, out, format, threads);
+}
@@ -0,0 +1,80 @@
+#ifndef NEWICK_RF_H
+#define NEWICK_RF_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "matrix_writer.h"
+#include "node.h"
+#include "splits.h"
+
+/*
+ * Robinson-Foulds distances between trees on the same taxa, i.e. the number of bipartitions
+ * found in one of two trees but not the other.
+ *
+ * All splits go into one SplitTable, so each tree is stored as the sorted list of its split
+ * ids, and a single distance is a merge of two short lists of integers. For rows of the
+ * matrix we instead go through the trees containing each split of the row's tree, counting
+ * shared splits per tree in an array that stays in cache. This costs the number of shared
+ * splits rather than the number of splits per pair, which is much less for diverse trees.
+ */
+class RobinsonFoulds {
+    TaxonIndex taxa;
+    SplitTable table;
+    std::vector<std::size_t> offsets {0};  // Ids of tree i are ids[offsets[i], offsets[i + 1]).
+    std::vector<std::uint32_t> ids;
+    std::vector<std::vector<std::uint32_t>> trees;  // The trees containing each split.
+    bool normalize;
+
+    [[nodiscard]] std::size_t common(std::size_t i, std::size_t j) const;
+
+public:
+    /*
+     * With `normalize`, the matrix holds RF distances divided by the total number of splits of
+     * both trees, i.e. values in [0, 1].
+     */
+    explicit RobinsonFoulds(bool normalize = false) : normalize {normalize} {}
+
+    /*
+     * Add a tree. The tips of the first tree define the taxa; throws std::invalid_argument for
+     * later trees on other taxa.
+     */
+    void add(const Node& tree);
+
+    [[nodiscard]] std::size_t size() const {
+        return offsets.size() - 1;
+    }
+    /*
+     * Trees are labelled by their 1-based position in the input.
+     */
+    [[nodiscard]] std::string label(const std::size_t i) const {
+        return std::to_string(i + 1);
+    }
+    [[nodiscard]] std::size_t splits(const std::size_t i) const {
+        return offsets[i + 1] - offsets[i];
+    }
+    /*
+     * The number of distinct splits over all trees.
+     */
+    [[nodiscard]] std::size_t distinct_splits() const {
+        return table.size();
+    }
+    [[nodiscard]] std::size_t distance(std::size_t i, std::size_t j) const;
+    /*
+     * The distance divided by the number of splits of both trees; 0 if neither has any.
+     */
+    [[nodiscard]] double normalized_distance(std::size_t i, std::size_t j) const;
+
+    /*
+     * Write rows [first, last) of the (possibly normalized) matrix to `out`, splitting them
+     * across `threads` threads.
+     */
+    template<typename T>
+    void rows(std::size_t first, std::size_t last, T* out, unsigned threads = 1) const;
+};
+
+void write_rf(const RobinsonFoulds& rf, std::ostream& out, DistanceFormat format, unsigned threads = 1);
+
+#endif //NEWICK_RF_H
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "splits.h"
+
+
+TaxonIndex::TaxonIndex(const Node& tree) {
+    std::vector<const Node*> stack {&tree};
+    while (!stack.empty()) {
+        const Node* node {stack.back()};
+        stack.pop_back();
+        const auto& children {node->get_children()};
+        if (children.empty()) {
+            add(node->name);
+        }
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.push_back(child->get());
+        }
+    }
+}
+
+std::uint32_t TaxonIndex::add(const std::string_view label) {
+    if (const auto id {find(label)}) {
+        return *id;
+    }
+    const auto id {static_cast<std::uint32_t>(labels.size())};
+    labels.emplace_back(label);
+    ids.emplace(labels.back(), id);
+    return id;
+}
+
+std::optional<std::uint32_t> TaxonIndex::find(const std::string_view label) const {
+    const auto it {ids.find(label)};
+    if (it == ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+
+static std::uint64_t mix(std::uint64_t x) {  // The finalizer of SplitMix64.
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+SplitHash hash_split(const std::span<const std::uint64_t> words) {
+    SplitHash h {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL};
+    for (const std::uint64_t word : words) {
+        h.low = mix(h.low ^ word);
+        h.high = mix(h.high + std::rotl(word, 32) + 0x165667B19E3779F9ULL);
+    }
+    return h;
+}
+
+
+void SplitTable::grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    const std::size_t mask {slots.size() - 1};
+    for (const Slot& slot : old) {
+        if (slot.id != UINT32_MAX) {
+            std::size_t i {slot.hash.low & mask};
+            while (slots[i].id != UINT32_MAX) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
+
+std::uint32_t SplitTable::insert(const SplitHash& hash) {
+    if (2 * (count + 1) > slots.size()) {
+        grow();
+    }
+    const std::size_t mask {slots.size() - 1};
+    std::size_t i {hash.low & mask};
+    while (slots[i].id != UINT32_MAX) {
+        if (slots[i].hash == hash) {
+            return slots[i].id;
+        }
+        i = (i + 1) & mask;
+    }
+    slots[i] = Slot {hash, static_cast<std::uint32_t>(count++)};
+    return slots[i].id;
+}
+
+std::optional<std::uint32_t> SplitTable::find(const SplitHash& hash) const {
+    const std::size_t mask {slots.size() - 1};
+    for (std::size_t i = hash.low & mask; slots[i].id != UINT32_MAX; i = (i + 1) & mask) {
+        if (slots[i].hash == hash) {
+            return slots[i].id;
+        }
+    }
+    return std::nullopt;
+}
+
+
+Splits::Splits(const Node& tree, const TaxonIndex& taxa_)
+    : words {(taxa_.size() + 63) / 64}
+{
+    // Preorder, with parent indices, and a bitset row for each inner node but the root.
+    std::vector<const Node*> preorder;
+    std::vector<std::size_t> parents;
+    std::vector<std::size_t> rows;  // Row of each node, or -1 for tips and the root.
+    std::vector<std::pair<const Node*, std::size_t>> stack {{&tree, 0}};
+    std::size_t inner {0};
+    while (!stack.empty()) {
+        const auto [node, parent] {stack.back()};
+        stack.pop_back();
+        const std::size_t index {preorder.size()};
+        preorder.push_back(node);
+        parents.push_back(parent);
+        const auto& children {node->get_children()};
+        rows.push_back(children.empty() || index == 0 ? SIZE_MAX : inner++);
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.emplace_back(child->get(), index);
+        }
+    }
+    std::vector<std::uint64_t> all(inner * words);
+    std::vector<std::uint64_t> seen(words);  // The taxa of the tree.
+
+    // In reverse preorder, all descendants of a node come before the node. The root has no
+    // parent row, but is the tip of a single-tip tree.
+    for (std::size_t i = preorder.size(); i-- > 0;) {
+        const std::size_t parent_row {rows[parents[i]]};
+        if (preorder[i]->get_children().empty()) {
+            const auto taxon {taxa_.find(preorder[i]->name)};
+            if (!taxon) {
+                throw std::invalid_argument("unknown taxon: " + preorder[i]->name);
+            }
+            if ((seen[*taxon / 64] >> (*taxon % 64)) & 1) {
+                throw std::invalid_argument("duplicate taxon: " + preorder[i]->name);
+            }
+            seen[*taxon / 64] |= std::uint64_t {1} << (*taxon % 64);
+            tip_count++;
+            if (parent_row != SIZE_MAX) {
+                all[parent_row * words + *taxon / 64] |= std::uint64_t {1} << (*taxon % 64);
+            }
+        } else if (parent_row != SIZE_MAX) {
+            std::uint64_t* const target {all.data() + parent_row * words};
+            const std::uint64_t* const source {all.data() + rows[i] * words};
+            for (std::size_t w = 0; w < words; w++) {
+                target[w] |= source[w];
+            }
+        }
+    }
+
+    // Normalize to the side without the first taxon of the tree - not of the index, which
+    // trees covering part of it may lack - and keep the nontrivial splits, each once.
+    const auto first_word {std::ranges::find_if(seen, [](const std::uint64_t word) { return word != 0; })};
+    if (first_word == seen.end()) {
+        return;  // No tips, no splits.
+    }
+    const auto first {static_cast<std::size_t>(first_word - seen.begin())};
+    const std::uint64_t first_bit {std::uint64_t {1} << std::countr_zero(*first_word)};
+    std::vector<std::pair<SplitHash, std::size_t>> candidates;
+    for (std::size_t i = 1; i < preorder.size(); i++) {
+        if (rows[i] == SIZE_MAX) {
+            continue;
+        }
+        std::uint64_t* const row {all.data() + rows[i] * words};
+        if (row[first] & first_bit) {
+            for (std::size_t w = 0; w < words; w++) {
+                row[w] = seen[w] & ~row[w];
+            }
+        }
+        std::size_t count {0};
+        for (std::size_t w = 0; w < words; w++) {
+            count += static_cast<std::size_t>(std::popcount(row[w]));
+        }
+        if (count >= 2 && count + 2 <= tip_count) {
+            candidates.emplace_back(hash_split({row, words}), i);
+        }
+    }
+    std::ranges::sort(candidates);
+    bits.reserve(candidates.size() * words);
+    for (std::size_t c = 0; c < candidates.size(); c++) {
+        const auto& [h, i] {candidates[c]};
+        const std::uint64_t* const row {all.data() + rows[i] * words};
+        if (c > 0 && candidates[c - 1].first == h
+                && std::equal(row, row + words, all.data() + rows[candidates[c - 1].second] * words)) {
+            continue;  // E.g. the two sides of the root of a rooted tree.
+        }
+        bits.insert(bits.end(), row, row + words);
+        hashes.push_back(h);
+        nodes.push_back(preorder[i]);
+    }
+}
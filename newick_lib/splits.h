@@ -0,0 +1,141 @@
+#ifndef NEWICK_SPLITS_H
+#define NEWICK_SPLITS_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "node.h"
+
+/*
+ * Numbering of taxa (tip labels), shared by the trees to be compared.
+ */
+class TaxonIndex {
+    struct Hash {
+        using is_transparent = void;
+        std::size_t operator()(const std::string_view label) const {
+            return std::hash<std::string_view> {}(label);
+        }
+    };
+    std::vector<std::string> labels;
+    std::unordered_map<std::string, std::uint32_t, Hash, std::equal_to<>> ids;
+
+public:
+    TaxonIndex() = default;
+    /*
+     * Index the tip labels of a tree, in preorder.
+     */
+    explicit TaxonIndex(const Node& tree);
+
+    /*
+     * The id of a label, adding it if it isn't indexed yet.
+     */
+    std::uint32_t add(std::string_view label);
+    [[nodiscard]] std::optional<std::uint32_t> find(std::string_view label) const;
+    [[nodiscard]] std::size_t size() const {
+        return labels.size();
+    }
+    [[nodiscard]] const std::string& label(const std::uint32_t id) const {
+        return labels[id];
+    }
+};
+
+struct SplitHash {
+    std::uint64_t low;
+    std::uint64_t high;
+
+    bool operator==(const SplitHash&) const = default;
+    auto operator<=>(const SplitHash&) const = default;
+};
+
+/*
+ * 128-bit hash of a split, i.e. of its words.
+ */
+[[nodiscard]] SplitHash hash_split(std::span<const std::uint64_t> words);
+
+/*
+ * Numbering of distinct splits, keyed by their 128-bit hash alone, i.e. we rely on the hash
+ * for equality. Ids are consecutive, in order of insertion. An open addressing table, grown
+ * as needed.
+ */
+class SplitTable {
+    struct Slot {
+        SplitHash hash { 0, 0 };
+        std::uint32_t id { UINT32_MAX };  // UINT32_MAX for empty slots.
+    };
+    std::vector<Slot> slots;
+    std::size_t count { 0 };
+
+    void grow();
+
+public:
+    SplitTable() : slots(64) {}
+
+    /*
+     * The id of a split, adding it if it isn't in the table yet.
+     */
+    std::uint32_t insert(const SplitHash& hash);
+    [[nodiscard]] std::optional<std::uint32_t> find(const SplitHash& hash) const;
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+};
+
+/*
+ * The nontrivial bipartitions (splits) of a tree, i.e. those with at least two taxa on each
+ * side, as bitsets over a TaxonIndex. All splits are stored in one flat array, with a fixed
+ * number of 64-bit words per split.
+ *
+ * Splits are normalized to the side not containing the first taxon of the tree, so that equal
+ * bipartitions have equal bitsets, no matter where the tree is rooted. Each bipartition is
+ * listed once. For trees covering only part of the TaxonIndex, the other taxa are on neither
+ * side, so such splits are comparable between trees with the same taxa only.
+ */
+class Splits {
+    std::size_t tip_count { 0 };
+    std::size_t words { 0 };  // Per split.
+    std::vector<std::uint64_t> bits;
+    std::vector<SplitHash> hashes;
+    std::vector<const Node*> nodes;  // The node below which the split is.
+
+public:
+    /*
+     * Computes the bitsets of all nodes in one pass from the tips up, OR-ing the bitsets of
+     * children into their parent's. Throws std::invalid_argument for tips not in `taxa`, or
+     * taxa occurring more than once in the tree.
+     */
+    Splits(const Node& tree, const TaxonIndex& taxa);
+
+    [[nodiscard]] std::size_t size() const {
+        return hashes.size();
+    }
+    /*
+     * The number of tips of the tree, which is less than the number of taxa if the tree
+     * covers only part of them.
+     */
+    [[nodiscard]] std::size_t tips() const {
+        return tip_count;
+    }
+    [[nodiscard]] std::size_t words_per_split() const {
+        return words;
+    }
+    [[nodiscard]] std::span<const std::uint64_t> split(const std::size_t i) const {
+        return {bits.data() + i * words, words};
+    }
+    [[nodiscard]] const SplitHash& hash(const std::size_t i) const {
+        return hashes[i];
+    }
+    [[nodiscard]] const Node* node(const std::size_t i) const {
+        return nodes[i];
+    }
+    [[nodiscard]] bool contains(const std::size_t i, const std::uint32_t taxon) const {
+        return (bits[i * words + taxon / 64] >> (taxon % 64)) & 1;
+    }
+};
+
+#endif //NEWICK_SPLITS_H
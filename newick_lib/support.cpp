@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "nexus.h"
+#include "support.h"
+
+
+SplitSupport::SplitSupport(Node& reference)
+    : reference {reference}, taxa {reference}, splits {reference, taxa}, counts(splits.size())
+{
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        table.insert(splits.hash(i));
+    }
+}
+
+void SplitSupport::count(const Node& tree, std::vector<std::uint64_t>& into) const {
+    const Splits other {tree, taxa};
+    if (other.tips() != taxa.size()) {
+        throw std::invalid_argument("tree has different taxa than the reference tree");
+    }
+    for (std::size_t i = 0; i < other.size(); i++) {
+        if (const auto id {table.find(other.hash(i))}) {
+            into[*id]++;
+        }
+    }
+}
+
+void SplitSupport::add(const Node& tree) {
+    count(tree, counts);
+    tree_count++;
+}
+
+void SplitSupport::add(TreeReader& reader, const unsigned threads) {
+    const auto* nexus {dynamic_cast<const NexusReader*>(&reader)};
+    std::vector<std::vector<std::uint64_t>> shards(std::max(threads, 1U), std::vector<std::uint64_t>(splits.size()));
+    std::vector<std::uint64_t> shard_trees(shards.size());
+    parse_parallel(reader, threads, [&](const unsigned thread, std::string_view, Node& tree) {
+        if (nexus != nullptr) {
+            nexus->translate(tree);
+        }
+        count(tree, shards[thread]);
+        shard_trees[thread]++;
+    });
+    for (std::size_t thread = 0; thread < shards.size(); thread++) {
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            counts[i] += shards[thread][i];
+        }
+        tree_count += shard_trees[thread];
+    }
+}
+
+void SplitSupport::annotate() {
+    // Splits only hold const nodes, so we find the nodes to label in the reference itself.
+    std::unordered_map<const Node*, std::size_t> split_of;
+    for (std::size_t i = 0; i < splits.size(); i++) {
+        split_of.emplace(splits.node(i), i);
+    }
+    const auto& root_children {reference.get_children()};
+    char number[32];
+    for (Node* node : reference.traverse()) {
+        auto found {split_of.find(node)};
+        if (found == split_of.end() && root_children.size() == 2 && node->get_parent() == &reference
+                && !node->get_children().empty()) {  // The other side of a split at the root.
+            found = split_of.find(root_children[0].get() == node ? root_children[1].get() : root_children[0].get());
+        }
+        if (found == split_of.end()) {
+            continue;
+        }
+        const std::size_t i {found->second};
+        const double support {tree_count == 0 ? 0.0 : static_cast<double>(counts[i]) / static_cast<double>(tree_count)};
+        node->name.assign(number, std::to_chars(number, number + sizeof number, support, std::chars_format::general, 6).ptr);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef NEWICK_SUPPORT_H
+#define NEWICK_SUPPORT_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "node.h"
+#include "reader.h"
+#include "splits.h"
+
+/*
+ * Support of the clades of a reference tree, e.g. an ML tree, by a sample of trees, e.g.
+ * bootstrap or posterior trees: the fraction of the trees containing each split of the
+ * reference.
+ *
+ * Only the splits of the reference go into the SplitTable; the splits of the sample are just
+ * looked up, so memory does not grow with the sample.
+ */
+class SplitSupport {
+    Node& reference;
+    TaxonIndex taxa;
+    Splits splits;
+    SplitTable table;  // Ids are the indices into `splits`.
+    std::vector<std::uint64_t> counts;
+    std::uint64_t tree_count { 0 };
+
+    void count(const Node& tree, std::vector<std::uint64_t>& into) const;
+
+public:
+    explicit SplitSupport(Node& reference);
+
+    /*
+     * Count the reference splits found in a tree. Throws std::invalid_argument for trees on
+     * other taxa than the reference.
+     */
+    void add(const Node& tree);
+    /*
+     * Count all remaining trees of `reader`, on `threads` threads with their own counts, which
+     * are summed up at the end. NEXUS trees are translated.
+     */
+    void add(TreeReader& reader, unsigned threads = 1);
+
+    [[nodiscard]] std::uint64_t trees() const {
+        return tree_count;
+    }
+    [[nodiscard]] const Splits& get_splits() const {
+        return splits;
+    }
+    [[nodiscard]] std::uint64_t count(const std::size_t i) const {
+        return counts[i];
+    }
+    /*
+     * Label the inner nodes of the reference tree with the support of their split. Both
+     * children of a bifurcating root have the same split, so they get the same label.
+     */
+    void annotate();
+};
+
+#endif //NEWICK_SUPPORT_H
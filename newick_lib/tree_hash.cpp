@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+#include "tree_hash.h"
+
+
+static std::uint64_t mix(std::uint64_t x) {  // The finalizer of SplitMix64.
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*
+ * Fold a value into a hash, depending on the order of the values.
+ */
+static void combine(TreeHash& h, const std::uint64_t value) {
+    h.low = mix(h.low ^ value);
+    h.high = mix(h.high + std::rotl(value, 32) + 0x165667B19E3779F9ULL);
+}
+
+/*
+ * Up to 8 bytes as a little-endian word, so that hashes of text do not depend on the platform.
+ */
+static std::uint64_t load_little_endian(const char* bytes, const std::size_t size) {
+    std::uint64_t word {0};
+    std::memcpy(&word, bytes, size);
+    if constexpr (std::endian::native == std::endian::big) {
+        word = std::byteswap(word);
+    }
+    return word;
+}
+
+static void combine(TreeHash& h, const std::string_view text) {
+    combine(h, text.size());
+    std::size_t i {0};
+    for (; i + 8 <= text.size(); i += 8) {
+        combine(h, load_little_endian(text.data() + i, 8));
+    }
+    if (i < text.size()) {
+        combine(h, load_little_endian(text.data() + i, text.size() - i));
+    }
+}
+
+TreeHash canonical_hash(const Node& tree, const TreeHashOptions& options) {
+    const double scale {std::pow(10.0, options.digits)};
+    // Postorder: the hashes of the children of a node are the top entries of `hashes` when
+    // the node is done.
+    std::vector<std::pair<const Node*, std::size_t>> stack {{&tree, 0}};  // Nodes and next child.
+    std::vector<TreeHash> hashes;
+    while (!stack.empty()) {
+        auto& [node, next] {stack.back()};
+        const auto& children {node->get_children()};
+        if (next < children.size()) {
+            stack.emplace_back(children[next++].get(), 0);  // Invalidates `node` and `next`.
+            continue;
+        }
+        TreeHash h {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL};
+        combine(h, children.size());
+        const auto first {hashes.end() - static_cast<std::ptrdiff_t>(children.size())};
+        std::sort(first, hashes.end());
+        for (auto child = first; child != hashes.end(); ++child) {
+            combine(h, child->low);
+            combine(h, child->high);
+        }
+        hashes.erase(first, hashes.end());
+        if (children.empty() ? options.tip_labels : options.inner_labels) {
+            combine(h, node->name);
+        }
+        if (options.lengths && node != &tree) {
+            combine(h, static_cast<std::uint64_t>(std::llround(node->branch_length_as_float() * scale)));
+        }
+        hashes.push_back(h);
+        stack.pop_back();
+    }
+    return hashes.back();
+}
+
+
+std::vector<TopologyCount> count_topologies(TreeReader& reader, const TreeHashOptions& options, const unsigned threads) {
+    struct Hash {
+        std::size_t operator()(const TreeHash& h) const {
+            return static_cast<std::size_t>(h.low);
+        }
+    };
+    using Counts = std::unordered_map<TreeHash, TopologyCount, Hash>;
+    std::vector<Counts> shards(std::max(threads, 1U));
+    parse_parallel(reader, threads, [&](const unsigned thread, const std::string_view newick, Node& tree) {
+        const TreeHash h {canonical_hash(tree, options)};
+        const std::size_t offset {reader.offset(newick)};
+        auto [it, inserted] {shards[thread].try_emplace(h, TopologyCount {h, 0, newick, offset})};
+        it->second.count++;
+        if (offset < it->second.offset) {
+            it->second.newick = newick;
+            it->second.offset = offset;
+        }
+    });
+    Counts& counts {shards[0]};
+    for (std::size_t thread = 1; thread < shards.size(); thread++) {
+        for (const auto& [h, count] : shards[thread]) {
+            auto [it, inserted] {counts.try_emplace(h, count)};
+            if (!inserted) {
+                it->second.count += count.count;
+                if (count.offset < it->second.offset) {
+                    it->second.newick = count.newick;
+                    it->second.offset = count.offset;
+                }
+            }
+        }
+    }
+    std::vector<TopologyCount> result;
+    result.reserve(counts.size());
+    for (const auto& [h, count] : counts) {
+        result.push_back(count);
+    }
+    std::ranges::sort(result, [](const TopologyCount& a, const TopologyCount& b) {
+        return a.count != b.count ? a.count > b.count : a.offset < b.offset;
+    });
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef NEWICK_TREE_HASH_H
+#define NEWICK_TREE_HASH_H
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "node.h"
+#include "reader.h"
+
+struct TreeHashOptions {
+    bool tip_labels { true };
+    bool inner_labels { false };
+    bool lengths { false };
+    int digits { 6 };  // Branch lengths are rounded to this many decimal places.
+};
+
+struct TreeHash {
+    std::uint64_t low;
+    std::uint64_t high;
+
+    bool operator==(const TreeHash&) const = default;
+    auto operator<=>(const TreeHash&) const = default;
+};
+
+/*
+ * 128-bit hash of a rooted tree, which does not depend on the order of children: the hash of
+ * a node combines its label and branch length, if included, with the sorted hashes of its
+ * children. Computed in one postorder pass, so trees with equal hashes (barring collisions)
+ * are equal as unordered trees.
+ *
+ * The hash only depends on the options and the tree, not on the platform or process, so it
+ * can key persistent caches.
+ */
+[[nodiscard]] TreeHash canonical_hash(const Node& tree, const TreeHashOptions& options = {});
+
+struct TopologyCount {
+    TreeHash hash;
+    std::uint64_t count;
+    std::string_view newick;  // The first tree with the hash.
+    std::size_t offset;  // Of `newick` in the input.
+};
+
+/*
+ * Count the distinct trees (by canonical hash) of all remaining trees of `reader`, on `threads`
+ * threads. Returns the counts, most frequent first, and in order of first occurrence for ties.
+ */
+[[nodiscard]] std::vector<TopologyCount> count_topologies(TreeReader& reader, const TreeHashOptions& options = {},
+                                                          unsigned threads = 1);
+
+#endif //NEWICK_TREE_HASH_H
@@ -1,8 +1,18 @@
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util.h"
+
 
 /*
  * Read file into vector of characters.
@@ -22,3 +32,64 @@ std::vector<char> read_file(const std::string &filename) {
     }
     return vec;
 }
+
+
+MappedFile::MappedFile(const std::string& filename) {
+    const int fd { open(filename.c_str(), O_RDONLY) };
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + filename);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + filename);
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    if (size > 0) {  // Mapping zero bytes is an error, but empty files are fine.
+        void* p { mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map " + filename);
+        }
+        data = static_cast<const char*>(p);
+    }
+    close(fd);  // The mapping stays valid.
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data { std::exchange(other.data, nullptr) }, size { std::exchange(other.size, 0) } {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+
+InputBuffer InputBuffer::from_file(const std::string& filename) {
+    InputBuffer input;
+    input.file.emplace(filename);
+    return input;
+}
+
+InputBuffer InputBuffer::from_string(std::string text) {
+    InputBuffer input;
+    input.text = std::move(text);
+    return input;
+}
+
+InputBuffer InputBuffer::from_stream(std::istream& in) {
+    return from_string(std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+}
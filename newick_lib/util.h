@@ -3,8 +3,50 @@
 //
 #ifndef UNTITLED_UTIL_H
 #define UNTITLED_UTIL_H
+#include <cstddef>
+#include <istream>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 std::vector<char> read_file(const std::string& filename);
-#endif //UNTITLED_UTIL_H
\ No newline at end of file
+
+/*
+ * Read-only memory mapping of a whole file. Throws std::runtime_error if the file cannot be
+ * opened or mapped.
+ */
+class MappedFile {
+    const char* data { nullptr };
+    std::size_t size { 0 };
+
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] std::string_view view() const {
+        return {data, size};
+    }
+};
+
+/*
+ * The complete input of a command: memory-mapped if read from a file, copied otherwise.
+ */
+class InputBuffer {
+    std::optional<MappedFile> file;
+    std::string text;
+
+public:
+    [[nodiscard]] static InputBuffer from_file(const std::string& filename);
+    [[nodiscard]] static InputBuffer from_string(std::string text);
+    [[nodiscard]] static InputBuffer from_stream(std::istream& in);
+
+    [[nodiscard]] std::string_view view() const {
+        return file ? file->view() : std::string_view(text);
+    }
+};
+#endif //UNTITLED_UTIL_H